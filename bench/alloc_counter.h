@@ -0,0 +1,48 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#pragma once
+
+#include <cstdint>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Counts the heap allocations of the whole program, across its threads, by replacing the global operator new and
+// delete. The replacement is defined in alloc_counter.cpp, which only the test and the benchmark executables link, so
+// that the engine and its tools are never slowed down by it.
+
+struct AllocationCounts {
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t bytes = 0;  // Allocated.
+
+    AllocationCounts& operator+=(const AllocationCounts& other) noexcept {
+        allocations += other.allocations;
+        deallocations += other.deallocations;
+        bytes += other.bytes;
+        return *this;
+    }
+};
+
+inline AllocationCounts operator-(const AllocationCounts& a, const AllocationCounts& b) noexcept {
+    return {a.allocations - b.allocations, a.deallocations - b.deallocations, a.bytes - b.bytes};
+}
+
+// Since the start of the program.
+AllocationCounts allocation_counts() noexcept;
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
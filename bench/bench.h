@@ -0,0 +1,177 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#pragma once
+
+#include "alloc_counter.h"
+#include "perf_counters.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// A minimal microbenchmark harness: a benchmark is a function running a fixed batch of operations and returning
+// their number. After a warm-up, it is timed over a number of samples, each repeating the function until it lasts
+// long enough for the clock, and the time per operation of the samples is summarized by its percentiles.
+// The hardware counters, if given, are read around every timed sample, and reported per operation, as are the heap
+// allocations.
+
+// Keeps the compiler from optimizing away the computation of a value.
+template<typename T>
+inline void do_not_optimize(const T& value) noexcept {
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct BenchmarkOptions {
+    int samples = 15;
+    int warmup_samples = 2;
+    std::chrono::milliseconds min_sample_time{50};
+    PerfCounters* counters = nullptr;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    uint64_t ops_per_sample = 0;
+    std::vector<double> ns_per_op;  // One per sample, in ascending order.
+    PerfCounterValues counters;     // Summed over the samples.
+    AllocationCounts allocations;   // Summed over the samples.
+    uint64_t counted_ops = 0;
+
+    // Linearly interpolated, `p` in [0, 100].
+    double percentile(double p) const noexcept {
+        if (ns_per_op.empty()) return 0.0;
+        const double rank = p / 100.0 * static_cast<double>(ns_per_op.size() - 1);
+        const auto lower = static_cast<size_t>(std::floor(rank));
+        const auto upper = std::min(lower + 1, ns_per_op.size() - 1);
+        return ns_per_op[lower] + (rank - static_cast<double>(lower)) * (ns_per_op[upper] - ns_per_op[lower]);
+    }
+
+    double median() const noexcept { return percentile(50.0); }
+    double ops_per_second() const noexcept { return median() > 0.0 ? 1e9 / median() : 0.0; }
+
+    bool has_counter(PerfCounter c) const noexcept { return counters.valid[c] && counted_ops > 0; }
+    double counter_per_op(PerfCounter c) const noexcept {
+        return has_counter(c) ? counters.values[c] / static_cast<double>(counted_ops) : 0.0;
+    }
+    double allocations_per_op() const noexcept {
+        return counted_ops ? static_cast<double>(allocations.allocations) / static_cast<double>(counted_ops) : 0.0;
+    }
+    double allocated_bytes_per_op() const noexcept {
+        return counted_ops ? static_cast<double>(allocations.bytes) / static_cast<double>(counted_ops) : 0.0;
+    }
+    double instructions_per_cycle() const noexcept {
+        return has_counter(Cycles) && counters.values[Cycles] > 0.0 ? counters.values[Instructions] / counters.values[Cycles] : 0.0;
+    }
+};
+
+// The default setup of a benchmark: nothing, so that a sample is timed in one go.
+struct NoBenchmarkSetup {
+    void operator()() const noexcept {}
+};
+
+// The setup, if given, runs before every repetition of the function, outside of the time, the counters and the
+// allocations of the sample.
+template<typename FnT, typename SetupT = NoBenchmarkSetup>
+BenchmarkResult run_benchmark(std::string name, const BenchmarkOptions& options, const FnT& fn, const SetupT& setup = {}) {
+    using Clock = std::chrono::steady_clock;
+
+    // Calibration: the repetitions of the function needed to fill a sample.
+    setup();
+    const auto calibration_start = Clock::now();
+    fn();
+    const auto once = std::max(Clock::now() - calibration_start, Clock::duration{1});
+    const auto repetitions = std::max<int64_t>(1, options.min_sample_time / once);
+
+    auto result = BenchmarkResult{};
+    result.name = std::move(name);
+    for (int sample = -options.warmup_samples; sample < options.samples; ++sample) {
+        uint64_t ops = 0;
+        auto duration = Clock::duration{0};
+        auto counters = PerfCounterValues{};
+        auto allocations = AllocationCounts{};
+        const auto measure = [&](int64_t count) {
+            const auto allocations_before = allocation_counts();
+            if (options.counters) options.counters->start();
+            const auto start_time = Clock::now();
+            for (int64_t i = 0; i < count; ++i) {
+                ops += fn();
+            }
+            duration += Clock::now() - start_time;
+            if (options.counters) counters += options.counters->stop();
+            allocations += allocation_counts() - allocations_before;
+        };
+        if constexpr (std::is_same_v<SetupT, NoBenchmarkSetup>) {
+            measure(repetitions);
+        } else {
+            for (int64_t i = 0; i < repetitions; ++i) {
+                setup();
+                measure(1);
+            }
+        }
+        const auto dur_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        if (sample < 0 || ops == 0) continue;
+        result.counters += counters;
+        result.allocations += allocations;
+        result.counted_ops += ops;
+        result.ops_per_sample = ops;
+        result.ns_per_op.push_back(static_cast<double>(dur_nsec) / static_cast<double>(ops));
+    }
+    std::sort(std::begin(result.ns_per_op), std::end(result.ns_per_op));
+    return result;
+}
+
+inline void write_json(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+    out.unsetf(std::ios::floatfield);
+    out.precision(6);
+    out << "{\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << (i ? "," : "") << "\n    {\"name\": \"" << r.name << "\", \"unit\": \"ns/op\", \"samples\": " <<
+            r.ns_per_op.size() << ", \"ops_per_sample\": " << r.ops_per_sample <<
+            ", \"min\": " << r.percentile(0) << ", \"p10\": " << r.percentile(10) << ", \"median\": " << r.median() <<
+            ", \"p90\": " << r.percentile(90) << ", \"max\": " << r.percentile(100) <<
+            ", \"allocations_per_op\": " << r.allocations_per_op() << ", \"bytes_per_op\": " << r.allocated_bytes_per_op();
+        if (r.has_counter(Cycles) || r.has_counter(Instructions)) {
+            out << ", \"counters_per_op\": {";
+            bool first = true;
+            for (int c = 0; c < PerfCounterCount; ++c) {
+                if (!r.has_counter(static_cast<PerfCounter>(c))) continue;
+                out << (first ? "" : ", ") << "\"" << PerfCounterNames[c] << "\": " << r.counter_per_op(static_cast<PerfCounter>(c));
+                first = false;
+            }
+            if (r.has_counter(Cycles) && r.has_counter(Instructions)) out << ", \"ipc\": " << r.instructions_per_cycle();
+            out << "}";
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
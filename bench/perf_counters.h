@@ -0,0 +1,148 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Hardware performance counters of the calling thread, in user space, through Linux `perf_event_open`.
+// The counters the kernel or the machine does not permit (e.g. in a container or a VM, or with a restrictive
+// perf_event_paranoid setting) are left out, and on other systems there are none.
+
+enum PerfCounter {
+    Cycles,
+    Instructions,
+    BranchMisses,
+    L1DataMisses,
+    LastLevelCacheMisses,
+    PerfCounterCount,
+};
+
+constexpr std::array<const char*, PerfCounterCount> PerfCounterNames = {
+    "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses"};
+
+struct PerfCounterValues {
+    std::array<double, PerfCounterCount> values{};
+    std::array<bool, PerfCounterCount> valid{};
+
+    PerfCounterValues& operator+=(const PerfCounterValues& other) noexcept {
+        for (int i = 0; i < PerfCounterCount; ++i) {
+            values[i] += other.values[i];
+            valid[i] = valid[i] || other.valid[i];
+        }
+        return *this;
+    }
+};
+
+class PerfCounters {
+    std::array<int, PerfCounterCount> _fds;
+    std::string _error;
+
+public:
+    PerfCounters() noexcept {
+        _fds.fill(-1);
+#if defined(__linux__)
+        constexpr uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const std::array<std::pair<uint32_t, uint64_t>, PerfCounterCount> configs = {{
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_HW_CACHE, l1d_read_miss},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        }};
+        for (int i = 0; i < PerfCounterCount; ++i) {
+            auto attr = perf_event_attr{};
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = configs[i].first;
+            attr.config = configs[i].second;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            _fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (_fds[i] < 0 && _error.empty()) _error = std::string{PerfCounterNames[i]} + ": " + std::strerror(errno);
+        }
+#else
+        _error = "perf_event_open is available on Linux only";
+#endif
+    }
+
+    ~PerfCounters() {
+#if defined(__linux__)
+        for (const int fd : _fds) {
+            if (fd >= 0) close(fd);
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool any_available() const noexcept {
+        for (const int fd : _fds) {
+            if (fd >= 0) return true;
+        }
+        return false;
+    }
+
+    // Why the first of the unavailable counters could not be opened.
+    const std::string& error() const noexcept { return _error; }
+
+    void start() noexcept {
+#if defined(__linux__)
+        for (const int fd : _fds) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // The counts since `start`, scaled up if the kernel had to multiplex the counters.
+    PerfCounterValues stop() noexcept {
+        auto result = PerfCounterValues{};
+#if defined(__linux__)
+        for (int i = 0; i < PerfCounterCount; ++i) {
+            if (_fds[i] < 0) continue;
+            ioctl(_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t data[3] = {};  // value, time enabled, time running
+            if (read(_fds[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0) continue;
+            result.values[i] = static_cast<double>(data[0]) * static_cast<double>(data[1]) / static_cast<double>(data[2]);
+            result.valid[i] = true;
+        }
+#endif
+        return result;
+    }
+};
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
@@ -0,0 +1,246 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <rookmole/rookmole.h>
+#include "bench.h"
+using namespace rookmole;
+
+// Microbenchmarks of the hot primitives over a fixed corpus of positions, reported as nanoseconds per operation
+// (the median and the spread across the samples), optionally written as JSON for tracking across releases.
+// Where permitted, the hardware counters are reported per operation too (per node for the search), and so are the
+// heap allocations.
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+constexpr const char* CorpusFens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R b KQkq - 3 3",
+    "rnbqkbnr/pp1ppppp/8/2p5/4P3/8/PPPP1PPP/RNBQKBNR w KQkq c6 0 2",
+    "rnbqkb1r/ppp2ppp/4pn2/3p4/2PP4/2N5/PP2PPPP/R1BQKBNR w KQkq - 2 4",
+    "r2q1rk1/pp2bppp/2n1bn2/3p4/3P4/2NBBN2/PP3PPP/R2Q1RK1 w - - 0 11",
+    "r1b1k2r/ppppqppp/2n2n2/2b1p3/2B1P3/2NP1N2/PPP2PPP/R1BQK2R w KQkq - 5 6",
+    "8/5pk1/6p1/8/3R4/6PP/5PK1/3r4 w - - 0 40",
+    "8/8/4k3/3p4/3P4/4K3/8/8 w - - 0 50",
+    "8/8/8/4k3/8/8/8/4K2Q w - - 0 1",
+};
+
+constexpr int SearchDepth = 3;
+
+std::vector<GameState> load_corpus()
+{
+    auto corpus = std::vector<GameState>{};
+    for (const auto fen : CorpusFens) {
+        const auto state = parse_fen(fen);
+        if (!state) {
+            std::cerr << "Invalid corpus position: " << fen << std::endl;
+            std::exit(1);
+        }
+        corpus.push_back(*state);
+    }
+    return corpus;
+}
+
+std::vector<BenchmarkResult> run_all(const std::vector<GameState>& corpus, const BenchmarkOptions& options, std::string_view filter)
+{
+    auto corpus_moves = std::vector<MoveList>(corpus.size());
+    for (size_t i = 0; i < corpus.size(); ++i) get_legal_moves(corpus[i], corpus_moves[i]);
+
+    auto results = std::vector<BenchmarkResult>{};
+    const auto run = [&](const char* name, const auto& fn, const auto&... setup) {
+        if (!filter.empty() && std::string_view{name}.find(filter) == std::string_view::npos) return;
+        results.push_back(run_benchmark(name, options, fn, setup...));
+    };
+
+    run("get_legal_moves", [&]() -> uint64_t {
+        auto moves = MoveList{};
+        for (const auto& s : corpus) {
+            get_legal_moves(s, moves);
+            do_not_optimize(moves);
+        }
+        return corpus.size();
+    });
+
+    run("make_move", [&]() -> uint64_t {
+        uint64_t ops = 0;
+        for (size_t i = 0; i < corpus.size(); ++i) {
+            for (const auto m : corpus_moves[i]) do_not_optimize(make_move(corpus[i], m).state);
+            ops += corpus_moves[i].size();
+        }
+        return ops;
+    });
+
+    run("is_attacked_by", [&]() -> uint64_t {
+        for (const auto& s : corpus) {
+            for (int sq = 0; sq < 64; ++sq) {
+                do_not_optimize(is_attacked_by(Player::White, coord_of(sq), s));
+                do_not_optimize(is_attacked_by(Player::Black, coord_of(sq), s));
+            }
+        }
+        return 128 * corpus.size();
+    });
+
+    run("see", [&]() -> uint64_t {
+        uint64_t ops = 0;
+        for (size_t i = 0; i < corpus.size(); ++i) {
+            for (const auto m : corpus_moves[i]) do_not_optimize(see(corpus[i], m));
+            ops += corpus_moves[i].size();
+        }
+        return ops;
+    });
+
+    run("find_king", [&]() -> uint64_t {
+        for (const auto& s : corpus) {
+            do_not_optimize(find_king(Player::White, s));
+            do_not_optimize(find_king(Player::Black, s));
+        }
+        return 2 * corpus.size();
+    });
+
+    run("evaluate_hardcode", [&]() -> uint64_t {
+        for (const auto& s : corpus) do_not_optimize(evaluate_hardcode(s.player_to_move, GameNode{s}));
+        return corpus.size();
+    });
+
+    // Per node, from an empty evaluation cache. The cache is cleared in the setup, and the contexts are reused, so
+    // that only the search itself is measured.
+    auto search_contexts = std::vector<SearchContext>(corpus.size());
+    run("search", [&]() -> uint64_t {
+        uint64_t nodes = 0;
+        for (size_t i = 0; i < corpus.size(); ++i) {
+            auto& ctx = search_contexts[i];
+            const auto nodes_before = ctx.nodes;
+            do_not_optimize(alphabeta(ctx, GameNode{corpus[i]}, SearchDepth).value);
+            nodes += ctx.nodes - nodes_before;
+        }
+        return nodes;
+    }, [] { configure_eval_cache(eval_cache_size_log2()); });
+
+    return results;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+int main(int argc, char* argv[])
+{
+    auto options = BenchmarkOptions{};
+    auto filter = std::string{};
+    auto json_path = std::string{};
+    bool search_stats = false;
+    bool use_counters = true;
+
+    for (int i = 1; i < argc; ++i) {
+        const auto arg = std::string_view{argv[i]};
+        const bool has_value = i + 1 < argc;
+        if (arg == "--samples" && has_value) options.samples = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--warmup" && has_value) options.warmup_samples = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--min-time" && has_value) options.min_sample_time = std::chrono::milliseconds{std::atoi(argv[++i])};
+        else if (arg == "--filter" && has_value) filter = argv[++i];
+        else if (arg == "--json" && has_value) json_path = argv[++i];
+        else if (arg == "--search-stats") search_stats = true;
+        else if (arg == "--no-counters") use_counters = false;
+        else {
+            std::cerr << "Usage: rookmole.bench [options]\n"
+                "         --samples N    Timed samples per benchmark (the default is 15).\n"
+                "         --warmup N     Untimed samples first (the default is 2).\n"
+                "         --min-time MS  The least duration of a sample (the default is 50).\n"
+                "         --filter TEXT  Only the benchmarks with TEXT in their names.\n"
+                "         --json PATH    Writes the results as JSON, to stdout for '-' (and the\n"
+                "                        tables to stderr).\n"
+                "         --search-stats Prints the statistics of searching the corpus, as JSON.\n"
+                "         --no-counters  Does not read the hardware performance counters.\n";
+            return 2;
+        }
+    }
+
+    auto counters = std::optional<PerfCounters>{};
+    if (use_counters) {
+        counters.emplace();
+        if (counters->any_available()) options.counters = &*counters;
+        if (!counters->error().empty()) std::cerr << "Hardware counters unavailable (" << counters->error() << ")" << std::endl;
+    }
+
+    const auto corpus = load_corpus();
+    const auto results = run_all(corpus, options, filter);
+
+    // With the JSON on stdout, everything else goes to stderr, so that the JSON can be piped as it is.
+    auto& text = json_path == "-" ? std::cerr : std::cout;
+    text << std::left << std::setw(20) << "benchmark" << std::right << std::fixed << std::setprecision(1) <<
+        std::setw(12) << "median" << std::setw(12) << "p10" << std::setw(12) << "p90" <<
+        std::setw(12) << "min" << std::setw(14) << "ops/s" << std::setw(12) << "allocs/op" << std::setw(12) << "bytes/op" <<
+        "   (ns/op over " << options.samples << " samples)\n";
+    for (const auto& r : results) {
+        text << std::left << std::setw(20) << r.name << std::right <<
+            std::setw(12) << r.median() << std::setw(12) << r.percentile(10) << std::setw(12) << r.percentile(90) <<
+            std::setw(12) << r.percentile(0) << std::setw(14) << std::setprecision(0) << r.ops_per_second() <<
+            std::setprecision(2) << std::setw(12) << r.allocations_per_op() << std::setw(12) << r.allocated_bytes_per_op() <<
+            std::setprecision(1) << '\n';
+    }
+
+    if (options.counters) {
+        text << '\n' << std::left << std::setw(20) << "counters per op" << std::right << std::setw(8) << "IPC";
+        for (const auto name : PerfCounterNames) text << std::setw(16) << name;
+        text << '\n';
+        for (const auto& r : results) {
+            text << std::left << std::setw(20) << r.name << std::right << std::setprecision(2) << std::setw(8);
+            if (r.has_counter(Cycles) && r.has_counter(Instructions)) text << r.instructions_per_cycle();
+            else text << '-';
+            text << std::setprecision(1);
+            for (int c = 0; c < PerfCounterCount; ++c) {
+                text << std::setw(16);
+                if (r.has_counter(static_cast<PerfCounter>(c))) text << r.counter_per_op(static_cast<PerfCounter>(c));
+                else text << '-';
+            }
+            text << '\n';
+        }
+    }
+    text << std::flush;
+
+    if (search_stats) {
+        configure_eval_cache(eval_cache_size_log2());
+        auto stats = SearchStats{};
+        for (const auto& s : corpus) {
+            auto ctx = SearchContext{};
+            stats += alphabeta(ctx, GameNode{s}, SearchDepth).stats;
+        }
+        text << to_json(stats) << std::endl;
+    }
+
+    if (json_path == "-") {
+        write_json(std::cout, results);
+    }
+    else if (!json_path.empty()) {
+        auto out = std::ofstream{json_path};
+        write_json(out, results);
+        if (!out) {
+            std::cerr << "Cannot write " << json_path << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
@@ -13,8 +13,16 @@
 #pragma once
 
 #include "rookmole/evaluation.h"
+#include "rookmole/see.h"
 #include "rookmole/state.h"
+#include "rookmole/tablebase.h"
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <limits>
+#include <memory>
+#include <optional>
+#include <string>
 
 namespace rookmole {
 
@@ -22,56 +30,398 @@ namespace rookmole {
 
 // Alpha-Beta prunning algorithm: https://en.wikipedia.org/wiki/Alpha%E2%80%93beta_pruning
 
+constexpr int MaxSearchDepth = 64;  // In plies.
+
+// A mate score is `MateValue` less the distance to mate in plies: up to the search depth, and beyond it by a mate
+// found in the tablebases at a leaf.
+constexpr int MaxMatePlies = MaxSearchDepth + MaxTablebaseMatePlies;
+
+// Beyond the node count and the hash table counters, the statistics are collected only in builds with
+// ROOKMOLE_SEARCH_STATS defined (the CMake option of the same name), as their counters and timers sit on the
+// hottest path of the search.
+#if defined(ROOKMOLE_SEARCH_STATS)
+constexpr bool SearchStatsEnabled = true;
+#else
+constexpr bool SearchStatsEnabled = false;
+#endif
+
+struct SearchStats {
+    uint64_t nodes = 0;
+    HashTableStats pawn_hash;
+    HashTableStats eval_cache;
+
+    // Collected if `SearchStatsEnabled`:
+    uint64_t leaf_nodes = 0;          // Evaluated, or found in the tablebases, or searched on by the quiescence.
+    uint64_t quiescence_nodes = 0;    // Beyond the leaves.
+    uint64_t cutoffs = 0;
+    uint64_t first_move_cutoffs = 0;  // Cutoffs by the first child searched, which tell how good the ordering is.
+    std::array<uint64_t, MaxSearchDepth + 1> nodes_by_ply{};
+    int64_t movegen_nsec = 0;         // Generating and making the moves of the inner nodes.
+    int64_t eval_nsec = 0;            // Evaluating the leaves, and the children for the move ordering.
+
+    double first_move_cutoff_rate() const noexcept {
+        return cutoffs ? static_cast<double>(first_move_cutoffs) / static_cast<double>(cutoffs) : 0.0;
+    }
+
+    SearchStats& operator+=(const SearchStats& other) noexcept;
+};
+
+std::string to_json(const SearchStats& stats);
+
 struct SearchResult {
     MoveCoord move;
     int value;
+    SearchStats stats;  // Filled in by the top-level search call.
+
+    SearchResult() noexcept = default;
+    SearchResult(MoveCoord move, int value) noexcept : move{move}, value{value} {}
+};
+
+class OpeningBook;
+
+using Evaluator = int (*)(Player eval_player, const GameNode& node) noexcept;
+
+// The parts of the search which can be switched, e.g. to play engine configurations against each other.
+struct SearchOptions {
+    Evaluator evaluate = evaluate_cached;
+    bool move_ordering = true;  // The previous principal variation first, then the children weakest for the opponent.
+    bool quiescence = true;     // The leaves searched on until quiet (see `quiescence`).
+    const OpeningBook* book = nullptr;  // Consulted by `search` at the root.
+    const Tablebases* tablebases = nullptr;  // Probed below the root, replacing the subtrees of the covered endings.
+};
+
+// Lets another thread stop a search in progress. The deadlines are steady clock times in nanoseconds since its
+// epoch, and can be moved while searching (e.g. on a ponder hit).
+struct SearchSignals {
+    static constexpr int64_t no_deadline = std::numeric_limits<int64_t>::max();
+
+    std::atomic<bool> stop{false};
+    std::atomic<int64_t> deadline{no_deadline};       // The search is aborted once it passes.
+    std::atomic<int64_t> soft_deadline{no_deadline};  // No new iteration is started once it passes.
+
+    static int64_t now() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void reset() noexcept {
+        stop = false;
+        deadline = no_deadline;
+        soft_deadline = no_deadline;
+    }
+
+    void set_time_limits(std::chrono::milliseconds soft_limit, std::chrono::milliseconds hard_limit) noexcept {
+        const auto start = now();
+        soft_deadline = start + std::chrono::duration_cast<std::chrono::nanoseconds>(soft_limit).count();
+        deadline = start + std::chrono::duration_cast<std::chrono::nanoseconds>(hard_limit).count();
+    }
+};
+
+// Adds the duration of its scope to a counter of the search statistics, if they are enabled.
+class SearchStatsTimer {
+    int64_t* _counter = nullptr;
+    int64_t _start_time = 0;
+
+public:
+    explicit SearchStatsTimer(int64_t& counter) noexcept {
+        if constexpr (SearchStatsEnabled) {
+            _counter = &counter;
+            _start_time = SearchSignals::now();
+        }
+    }
+
+    ~SearchStatsTimer() {
+        if constexpr (SearchStatsEnabled) {
+            *_counter += SearchSignals::now() - _start_time;
+        }
+    }
+};
+
+// The moves and the children of a node, kept for the nodes at its ply to reuse.
+struct SearchPlyBuffers {
+    MoveList moves;
+    std::array<GameNode, MaxLegalMoves> child_nodes;
+    std::array<int, MaxLegalMoves> child_scores;
+    std::array<uint8_t, MaxLegalMoves> search_order;  // Indices of the moves.
+};
+
+// The state of a single search thread.
+struct SearchContext {
+    SearchOptions options;
+    uint64_t nodes = 0;
+    uint64_t node_limit = 0;                // 0: unlimited
+    const SearchSignals* signals = nullptr;
+    bool abortable = true;
+    bool aborted = false;
+    SearchStats stats;  // Of the current top-level call, except for the node count kept above.
+
+    // Triangular principal variation table: the best line found from each ply.
+    std::array<std::array<MoveCoord, MaxSearchDepth>, MaxSearchDepth> pv;
+    std::array<int, MaxSearchDepth + 1> pv_length;
+
+    // The principal variation of the previous iteration, searched first.
+    std::array<MoveCoord, MaxSearchDepth> pv_hint;
+    int pv_hint_length = 0;
+    bool follow_pv = false;
+
+    // Allocated on the first visit of a ply, so that a context searching again does not allocate at all.
+    std::array<std::unique_ptr<SearchPlyBuffers>, MaxSearchDepth> ply_buffers;
+
+    SearchPlyBuffers& buffers(int ply) {
+        auto& buffers = ply_buffers[ply];
+        if (!buffers) buffers = std::make_unique<SearchPlyBuffers>();
+        return *buffers;
+    }
+
+    // Counts a visited node and tells whether the search must be abandoned.
+    bool enter_node() noexcept {
+        ++nodes;
+        if (!abortable || aborted) return aborted;
+        if (node_limit != 0 && nodes >= node_limit) {
+            aborted = true;
+        }
+        else if (signals && (nodes % 256) == 0) {
+            aborted = signals->stop.load(std::memory_order_relaxed) ||
+                SearchSignals::now() >= signals->deadline.load(std::memory_order_relaxed);
+        }
+        return aborted;
+    }
 };
 
+// Mate scores are made ply-aware, so that quicker mates are preferred and their distance can be reported.
+inline int adjust_mate_value(int value, int ply) noexcept {
+    if (value >= MateValue) return value - ply;
+    if (value <= -MateValue) return value + ply;
+    return value;
+}
+
+// A tablebase result as seen by `eval_player`, with the distance to mate counted from the root.
+inline int tablebase_value(const TablebaseProbe& probe, Player player_to_move, Player eval_player, int ply) noexcept {
+    if (probe.wdl == TablebaseWdl::Draw) return 0;
+    const bool eval_player_wins = (probe.wdl == TablebaseWdl::Win) == (player_to_move == eval_player);
+    return adjust_mate_value(eval_player_wins ? MateValue : -MateValue, ply + probe.plies);
+}
+
+inline void count_cutoff(SearchContext& ctx, size_t search_index) noexcept {
+    if constexpr (SearchStatsEnabled) {
+        ++ctx.stats.cutoffs;
+        if (search_index == 0) ++ctx.stats.first_move_cutoffs;
+    }
+}
+
+// Most valuable victim, least valuable attacker: the captures of the most valuable pieces first, by the least valuable
+// ones preferably. Promotions count as the capture of a queen.
+inline int mvv_lva_score(const GameState& s, Move m) noexcept {
+    const int victim = m.is_capture() && m.flag() != MoveFlag::EnPassant ? piece_of(s.get_square(coord_of(m.to()))) : Piece::Pawn;
+    const int attacker = piece_of(s.get_square(coord_of(m.from())));
+    return 8 * (m.is_capture() ? victim : 0) + (m.is_promotion() ? 8 * Piece::Queen : 0) - attacker;
+}
+
+// Quiescence search: https://www.chessprogramming.org/Quiescence_Search
+// Searches on from a leaf with the captures and the promotions only (or with all the evasions, in check), until the
+// position is quiet, so that no leaf is evaluated in the middle of an exchange. Unless in check, the player to move
+// may also "stand pat" on the evaluation, i.e. decline to capture. The node is already entered by the caller.
 template<bool maximize>
-inline SearchResult alphabeta(Player eval_player, const GameNode& node, int depth, int alpha, int beta) noexcept {
-    if (depth == 0 || is_terminal(node)) {
-        return SearchResult{MoveCoord{}, evaluate_hardcode(eval_player, node)};
+inline int quiescence(SearchContext& ctx, Player eval_player, const GameNode& node, int ply, int alpha, int beta) noexcept {
+    const auto evaluate = [&ctx, eval_player, &node, ply]() {
+        const auto timer = SearchStatsTimer{ctx.stats.eval_nsec};
+        return adjust_mate_value(ctx.options.evaluate(eval_player, node), ply);
+    };
+
+    if (ply == MaxSearchDepth || node.state.move_count == 80) {
+        return evaluate();
     }
 
-    auto best_result = SearchResult{};
+    const bool in_check = node.king_in_check();
+    int best_value = maximize ? std::numeric_limits<int>::min() : std::numeric_limits<int>::max();
+    if (!in_check) {
+        best_value = evaluate();
+        if (maximize) {
+            if (best_value >= beta) return best_value;
+            alpha = std::max(alpha, best_value);
+        }
+        else {
+            if (best_value <= alpha) return best_value;
+            beta = std::min(beta, best_value);
+        }
+    }
+
+    auto& buffers = ctx.buffers(ply);
+    auto& moves = buffers.moves;
+    {
+        const auto timer = SearchStatsTimer{ctx.stats.movegen_nsec};
+        if (in_check) get_legal_moves<MoveGenMode::Evasions>(node.state, moves);
+        else get_legal_moves<MoveGenMode::Captures>(node.state, moves);
+    }
+    if (moves.empty()) {
+        return in_check ? evaluate() : best_value;  // Mated, or quiet.
+    }
+
+    const auto search_order = std::begin(buffers.search_order);
+    for (size_t i = 0; i < moves.size(); ++i) {
+        search_order[i] = static_cast<uint8_t>(i);
+        buffers.child_scores[i] = mvv_lva_score(node.state, moves[i]);
+    }
+    std::sort(search_order, search_order + moves.size(), [&buffers](int i1, int i2) {
+        return buffers.child_scores[i1] > buffers.child_scores[i2];
+    });
 
-    const size_t child_count = node.next_moves.size();
+    auto bbs = std::optional<Bitboards>{};
+    for (size_t search_index = 0; search_index < moves.size(); ++search_index) {
+        const auto move = moves[search_order[search_index]];
+        // A capture losing material in the exchange is not going to improve on standing pat.
+        if (!in_check) {
+            if (!bbs) bbs = make_bitboards(node.state);
+            if (!see_ge(node.state, *bbs, move, 0)) continue;
+        }
+
+        const auto child_node = make_move(node.state, move);
+        if constexpr (SearchStatsEnabled) {
+            ++ctx.stats.quiescence_nodes;
+            ++ctx.stats.nodes_by_ply[ply + 1];
+        }
+        if (ctx.enter_node()) break;
 
-    auto child_nodes = std::vector<GameNode>{};
-    child_nodes.reserve(child_count);
-    for (const auto move : node.next_moves) {
-        child_nodes.push_back(make_move(node.state, move));
+        const int value = quiescence<!maximize>(ctx, eval_player, child_node, ply + 1, alpha, beta);
+        if (ctx.aborted) break;
+        if (maximize) {
+            best_value = std::max(best_value, value);
+            alpha = std::max(alpha, value);
+        }
+        else {
+            best_value = std::min(best_value, value);
+            beta = std::min(beta, value);
+        }
+        if (alpha >= beta) {
+            count_cutoff(ctx, search_index);
+            break;
+        }
     }
+    return best_value;
+}
 
-    auto child_scores = std::vector<int>{};
-    child_scores.reserve(child_count);
-    for (const auto& child_node : child_nodes) {
-        child_scores.push_back(evaluate_hardcode(child_node.state.player_to_move, child_node));
+// Fills the search order of the children in `buffers`: with the move ordering, the children weakest for the opponent
+// first, the captures scored as if the exchange on the target square was played out, so that the ones losing material
+// come after the good ones; then the move of the previous principal variation in front, if `on_pv`.
+inline void order_children(SearchContext& ctx, const GameNode& node, int ply, bool on_pv, SearchPlyBuffers& buffers) noexcept {
+    const auto& next_moves = buffers.moves;
+    const auto& child_nodes = buffers.child_nodes;
+    const size_t child_count = next_moves.size();
+    const auto search_order_indices = std::begin(buffers.search_order);
+    const auto search_order_end = search_order_indices + child_count;
+    for (size_t i = 0; i < child_count; ++i) {
+        search_order_indices[i] = static_cast<uint8_t>(i);
     }
+    if (!ctx.options.move_ordering) return;
 
-    auto search_order_indices = std::vector<size_t>{};
-    search_order_indices.reserve(child_count);
+    auto& child_scores = buffers.child_scores;
+    {
+        const auto timer = SearchStatsTimer{ctx.stats.eval_nsec};
+        for (size_t i = 0; i < child_count; ++i) {
+            child_scores[i] = ctx.options.evaluate(child_nodes[i].state.player_to_move, child_nodes[i]);
+        }
+    }
+    auto bbs = std::optional<Bitboards>{};
     for (size_t i = 0; i < child_count; ++i) {
-        search_order_indices.push_back(i);
+        const auto move = next_moves[i];
+        if (!move.is_capture() && !move.is_promotion()) continue;
+        if (!bbs) bbs = make_bitboards(node.state);
+        child_scores[i] += capture_gain(node.state, move) - see(node.state, *bbs, move);
     }
 
-    std::sort(std::begin(search_order_indices), std::end(search_order_indices), [&](int i1, int i2) {
+    std::sort(search_order_indices, search_order_end, [&](int i1, int i2) {
         return child_scores[i1] < child_scores[i2];
     });
 
+    if (on_pv) {
+        const auto hint_it = std::find_if(search_order_indices, search_order_end, [&](size_t i) {
+            return to_move_coord(next_moves[i]) == ctx.pv_hint[ply];
+        });
+        if (hint_it != search_order_end) {
+            std::rotate(search_order_indices, hint_it, std::next(hint_it));
+        }
+    }
+}
+
+template<bool maximize>
+inline SearchResult alphabeta(SearchContext& ctx, Player eval_player, const GameNode& node, int depth, int ply, int alpha, int beta) noexcept {
+    ctx.pv_length[ply] = 0;
+    if constexpr (SearchStatsEnabled) {
+        ++ctx.stats.nodes_by_ply[ply];
+    }
+    if (ctx.enter_node()) {
+        return SearchResult{MoveCoord{}, 0};
+    }
+
+    if (ctx.options.tablebases && ply > 0) {
+        if (const auto probe = ctx.options.tablebases->probe(node.state)) {
+            if constexpr (SearchStatsEnabled) {
+                ++ctx.stats.leaf_nodes;
+            }
+            return SearchResult{MoveCoord{}, tablebase_value(*probe, node.state.player_to_move, eval_player, ply)};
+        }
+    }
+
+    if (depth == 0 && ctx.options.quiescence) {
+        if constexpr (SearchStatsEnabled) {
+            ++ctx.stats.leaf_nodes;
+        }
+        return SearchResult{MoveCoord{}, quiescence<maximize>(ctx, eval_player, node, ply, alpha, beta)};
+    }
+
+    if (depth == 0 || ply == MaxSearchDepth || is_terminal(node)) {
+        if constexpr (SearchStatsEnabled) {
+            ++ctx.stats.leaf_nodes;
+        }
+        const auto timer = SearchStatsTimer{ctx.stats.eval_nsec};
+        return SearchResult{MoveCoord{}, adjust_mate_value(ctx.options.evaluate(eval_player, node), ply)};
+    }
+
+    auto best_result = SearchResult{};
+
+    auto& buffers = ctx.buffers(ply);
+    const auto& next_moves = buffers.moves;
+    auto& child_nodes = buffers.child_nodes;
+
+    auto movegen_timer = std::optional<SearchStatsTimer>{ctx.stats.movegen_nsec};
+    if (node.king_in_check()) get_legal_moves<MoveGenMode::Evasions>(node.state, buffers.moves);
+    else get_legal_moves(node.state, buffers.moves);
+    const size_t child_count = next_moves.size();
+    for (size_t i = 0; i < child_count; ++i) {
+        child_nodes[i] = make_move(node.state, next_moves[i]);
+    }
+    movegen_timer.reset();
+
+    const bool on_pv = ctx.options.move_ordering && ctx.follow_pv && ply < ctx.pv_hint_length;
+    order_children(ctx, node, ply, on_pv, buffers);
+    const auto& search_order_indices = buffers.search_order;
+
+    auto update_pv = [&ctx, ply](MoveCoord move) {
+        ctx.pv[ply][0] = move;
+        const int child_pv_length = ply + 1 < MaxSearchDepth ? ctx.pv_length[ply + 1] : 0;
+        for (int i = 0; i < child_pv_length; ++i) {
+            ctx.pv[ply][i + 1] = ctx.pv[ply + 1][i];
+        }
+        ctx.pv_length[ply] = child_pv_length + 1;
+    };
+
     if (maximize) {
         best_result.value = std::numeric_limits<int>::min();
         for (size_t search_index = 0; search_index < child_count; ++search_index) {
             const int child_index = search_order_indices[search_index];
             const auto& child_node = child_nodes[child_index];
-            const auto child_result = alphabeta<false>(eval_player, child_node, depth - 1, alpha, beta);
+            ctx.follow_pv = on_pv && search_index == 0;
+            const auto child_result = alphabeta<false>(ctx, eval_player, child_node, depth - 1, ply + 1, alpha, beta);
+            if (ctx.aborted) break;
             if (child_result.value > best_result.value) {
                 best_result.value = child_result.value;
-                best_result.move = node.next_moves[child_index];
+                best_result.move = to_move_coord(next_moves[child_index]);
+                update_pv(best_result.move);
             }
 
             alpha = std::max(alpha, child_result.value);
             if (alpha >= beta) {
+                count_cutoff(ctx, search_index);
                 break;  // Beta-cutoff
             }
         }
@@ -81,14 +431,18 @@ inline SearchResult alphabeta(Player eval_player, const GameNode& node, int dept
         for (size_t search_index = 0; search_index < child_count; ++search_index) {
             const int child_index = search_order_indices[search_index];
             const auto& child_node = child_nodes[child_index];
-            const auto child_result = alphabeta<true>(eval_player, child_node, depth - 1, alpha, beta);
+            ctx.follow_pv = on_pv && search_index == 0;
+            const auto child_result = alphabeta<true>(ctx, eval_player, child_node, depth - 1, ply + 1, alpha, beta);
+            if (ctx.aborted) break;
             if (child_result.value < best_result.value) {
                 best_result.value = child_result.value;
-                best_result.move = node.next_moves[child_index];
+                best_result.move = to_move_coord(next_moves[child_index]);
+                update_pv(best_result.move);
             }
 
             beta = std::min(beta, child_result.value);
             if (beta <= alpha) {
+                count_cutoff(ctx, search_index);
                 break;  // Alpha-cutoff
             }
         }
@@ -97,8 +451,23 @@ inline SearchResult alphabeta(Player eval_player, const GameNode& node, int dept
     return best_result;
 }
 
-inline SearchResult alphabeta(const GameNode& node, int depth) noexcept {
-    return alphabeta<true>(node.state.player_to_move, node, depth, std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+inline SearchResult alphabeta(SearchContext& ctx, const GameNode& node, int depth) noexcept {
+    const auto pawn_hash_before = pawn_hash_stats();
+    const auto eval_cache_before = eval_cache_stats();
+    const auto nodes_before = ctx.nodes;
+    ctx.stats = SearchStats{};
+    auto result = alphabeta<true>(ctx, node.state.player_to_move, node, depth, 0, std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+    result.stats = ctx.stats;
+    result.stats.nodes = ctx.nodes - nodes_before;
+    result.stats.pawn_hash = pawn_hash_stats() - pawn_hash_before;
+    result.stats.eval_cache = eval_cache_stats() - eval_cache_before;
+    return result;
+}
+
+inline SearchResult alphabeta(const GameNode& node, int depth, const SearchOptions& options = {}) noexcept {
+    auto ctx = SearchContext{};
+    ctx.options = options;
+    return alphabeta(ctx, node, depth);
 }
 
 //=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
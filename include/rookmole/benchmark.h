@@ -0,0 +1,49 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#pragma once
+
+#include "rookmole/search.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// The `bench` command: a fixed list of positions, each searched to a fixed depth on a single thread, from a cleared
+// evaluation cache. The search being deterministic, the total node count is a signature of its behavior: two builds
+// with the same signature search alike, and differ in speed only.
+
+constexpr size_t BenchmarkPositionCount = 50;
+constexpr int DefaultBenchmarkDepth = 4;
+
+extern const std::array<const char*, BenchmarkPositionCount> BenchmarkFens;
+
+struct BenchmarkReport {
+    uint64_t nodes = 0;  // The signature.
+    std::chrono::microseconds time{0};
+
+    uint64_t nps() const noexcept { return time.count() > 0 ? nodes * 1000000 / time.count() : 0; }
+};
+
+using BenchmarkCallback = std::function<void(size_t index, const SearchReport& report)>;
+
+// The positions are searched as new games, i.e. with the move counters reset, so that none ends by the move limit.
+BenchmarkReport run_search_benchmark(int depth = DefaultBenchmarkDepth, const BenchmarkCallback& on_position = {});
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
@@ -0,0 +1,269 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+#pragma once
+
+#include "rookmole/state.h"
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// A set of squares. Bit N stands for the square with the same index as nibble N of `GameState::squares`,
+// i.e. a1 is bit 0, h1 is bit 7 and h8 is bit 63.
+using Bitboard = uint64_t;
+
+constexpr Bitboard bit(int index) noexcept { return Bitboard{1} << index; }
+constexpr Bitboard bit(Coord c) noexcept { return bit(square_index(c)); }
+
+constexpr Bitboard FileABitboard = 0x0101010101010101ull;
+constexpr Bitboard FileHBitboard = FileABitboard << 7;
+constexpr Bitboard file_bitboard(int file) noexcept { return FileABitboard << (file - 1); }
+constexpr Bitboard rank_bitboard(int rank) noexcept { return Bitboard{0xFF} << (8 * (rank - 1)); }
+
+constexpr Bitboard shift_north(Bitboard b) noexcept { return b << 8; }
+constexpr Bitboard shift_south(Bitboard b) noexcept { return b >> 8; }
+constexpr Bitboard shift_east(Bitboard b) noexcept { return (b << 1) & ~FileABitboard; }
+constexpr Bitboard shift_west(Bitboard b) noexcept { return (b >> 1) & ~FileHBitboard; }
+constexpr Bitboard shift_forward(Player p, Bitboard b) noexcept { return is_white(p) ? shift_north(b) : shift_south(b); }
+
+constexpr Bitboard fill_north(Bitboard b) noexcept { b |= b << 8; b |= b << 16; return b | (b << 32); }
+constexpr Bitboard fill_south(Bitboard b) noexcept { b |= b >> 8; b |= b >> 16; return b | (b >> 32); }
+constexpr Bitboard fill_forward(Player p, Bitboard b) noexcept { return is_white(p) ? fill_north(b) : fill_south(b); }
+
+// Squares attacked by the pawns of player `p`.
+constexpr Bitboard pawn_attacks(Player p, Bitboard pawns) noexcept {
+    const auto fwd = shift_forward(p, pawns);
+    return shift_east(fwd) | shift_west(fwd);
+}
+
+inline int popcount(Bitboard b) noexcept {
+#if defined(_MSC_VER)
+    return static_cast<int>(__popcnt64(b));
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+inline int lsb_index(Bitboard b) noexcept {
+    assert(b != 0);
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, b);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+
+inline int msb_index(Bitboard b) noexcept {
+    assert(b != 0);
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, b);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(b);
+#endif
+}
+
+template<typename CbT>
+void foreach_bit(Bitboard b, const CbT& cb) {
+    while (b != 0) {
+        cb(lsb_index(b));
+        b &= b - 1;
+    }
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Bitboard view of a nibble board.
+struct Bitboards {
+    std::array<Bitboard, 16> by_square;  // Indexed by `Square`. The `Empty` entry holds all the empty squares.
+
+    Bitboard of(Player p, Piece pc) const noexcept { return by_square[make_square(p, pc)]; }
+    Bitboard of(Player p) const noexcept {
+        return of(p, Piece::Pawn) | of(p, Piece::Knight) | of(p, Piece::Bishop) |
+            of(p, Piece::Rook) | of(p, Piece::Queen) | of(p, Piece::King);
+    }
+    Bitboard occupied() const noexcept { return ~by_square[Square::Empty]; }
+};
+
+// The occupied squares of a nibble board, 16 at a time (little-endian): a nibble is folded into its lowest bit, and the
+// bits four apart are then gathered together.
+inline Bitboard occupied_squares(const GameState& s) noexcept {
+    constexpr uint64_t LowNibbleBits = 0x1111111111111111ull;
+    uint64_t words[4];
+    static_assert(sizeof(words) == sizeof(s.squares));
+    std::memcpy(words, s.squares.data(), sizeof(words));
+
+    Bitboard occupied = 0;
+    for (int i = 0; i < 4; ++i) {
+        auto x = words[i];
+        x |= x >> 1;
+        x |= x >> 2;
+        x &= LowNibbleBits;
+        x = (x | x >> 3) & 0x0303030303030303ull;
+        x = (x | x >> 6) & 0x000F000F000F000Full;
+        x = (x | x >> 12) & 0x000000FF000000FFull;
+        x = (x | x >> 24) & 0xFFFF;
+        occupied |= x << (16 * i);
+    }
+    return occupied;
+}
+
+inline Bitboards make_bitboards(const GameState& s) noexcept {
+    auto bbs = Bitboards{};
+    const auto occupied = occupied_squares(s);
+    bbs.by_square[Square::Empty] = ~occupied;
+    foreach_bit(occupied, [&bbs, &s](int i) { bbs.by_square[s.square_at(i)] |= bit(i); });
+    return bbs;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Geometry tables, generated at compile time, so that neither the attack sets nor the lines between the squares take
+// any coordinate arithmetic or bounds checks to look up. All of them are indexed by `square_index`.
+
+// The directions ordered by the offset of a step in the square index, so that the rays of the last four directions run
+// up the indices (nearest square first in the order of `lsb_index`), and the rays of the first four run down.
+enum Direction : uint8_t {
+    SouthWest, South, SouthEast, West, East, NorthWest, North, NorthEast
+};
+
+constexpr Coord DirectionSteps[] = {{-1, -1}, {0, -1}, {1, -1}, {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+constexpr Direction StraightDirections[] = {South, West, East, North};
+constexpr Direction DiagonalDirections[] = {SouthWest, SouthEast, NorthWest, NorthEast};
+
+constexpr bool runs_up(Direction dir) noexcept { return dir >= East; }
+
+using SquareTable = std::array<Bitboard, 64>;
+
+template<size_t StepCount>
+constexpr SquareTable make_step_table(const Coord (&steps)[StepCount]) noexcept {
+    auto table = SquareTable{};
+    for (int index = 0; index < 64; ++index) {
+        for (const auto step : steps) {
+            const auto c = coord_of(index) + step;
+            if (is_valid(c)) table[index] |= bit(c);
+        }
+    }
+    return table;
+}
+
+constexpr std::array<SquareTable, 8> make_ray_table() noexcept {
+    auto table = std::array<SquareTable, 8>{};
+    for (int dir = 0; dir < 8; ++dir) {
+        for (int index = 0; index < 64; ++index) {
+            for (auto c = coord_of(index) + DirectionSteps[dir]; is_valid(c); c = c + DirectionSteps[dir]) {
+                table[dir][index] |= bit(c);
+            }
+        }
+    }
+    return table;
+}
+
+constexpr Coord KnightSteps[] = {{-1, -2}, {1, -2}, {-2, -1}, {2, -1}, {-2, 1}, {2, 1}, {-1, 2}, {1, 2}};
+constexpr Coord WhitePawnSteps[] = {{-1, 1}, {1, 1}};
+constexpr Coord BlackPawnSteps[] = {{-1, -1}, {1, -1}};
+
+inline constexpr auto KnightAttackTable = make_step_table(KnightSteps);
+inline constexpr auto KingAttackTable = make_step_table(DirectionSteps);
+inline constexpr std::array<SquareTable, 2> PawnAttackTable = {make_step_table(WhitePawnSteps), make_step_table(BlackPawnSteps)};
+inline constexpr auto RayTable = make_ray_table();  // Indexed by `Direction` first. The square itself excluded.
+
+// For every two squares on a common line: the squares strictly between them (`between`), or the whole line through
+// both of them, edge to edge (`line`). Empty for the squares not on a common line.
+template<bool between>
+constexpr std::array<SquareTable, 64> make_line_table() noexcept {
+    auto table = std::array<SquareTable, 64>{};
+    for (int dir = 0; dir < 8; ++dir) {
+        const int opposite = 7 - dir;
+        for (int from = 0; from < 64; ++from) {
+            for (int to = 0; to < 64; ++to) {
+                if (!(RayTable[dir][from] & bit(to))) continue;
+                table[from][to] = between ?
+                    RayTable[dir][from] & RayTable[opposite][to] :
+                    RayTable[dir][from] | RayTable[opposite][from] | bit(from);
+            }
+        }
+    }
+    return table;
+}
+
+inline constexpr auto BetweenTable = make_line_table<true>();
+inline constexpr auto LineTable = make_line_table<false>();
+
+constexpr Bitboard between_mask(int from, int to) noexcept { return BetweenTable[from][to]; }
+constexpr Bitboard line_mask(int from, int to) noexcept { return LineTable[from][to]; }
+constexpr Bitboard ray_mask(Direction dir, int index) noexcept { return RayTable[dir][index]; }
+
+// The square nearest to the origin of a ray.
+inline int nearest_on_ray(Direction dir, Bitboard squares) noexcept {
+    return runs_up(dir) ? lsb_index(squares) : msb_index(squares);
+}
+
+// Calls `cb` with the square indices on the ray from `index` in the direction `dir`, nearest first, until it returns
+// false.
+template<typename CbT>
+void foreach_on_ray(int index, Direction dir, const CbT& cb) {
+    auto ray = ray_mask(dir, index);
+    while (ray != 0) {
+        const int i = nearest_on_ray(dir, ray);
+        if (!cb(i)) return;
+        ray ^= bit(i);
+    }
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Pseudo-legal attack sets. Sliding pieces are stopped by the first occupied square, which is included.
+
+constexpr Bitboard knight_attacks(int index) noexcept { return KnightAttackTable[index]; }
+constexpr Bitboard knight_attacks(Coord c) noexcept { return knight_attacks(square_index(c)); }
+
+constexpr Bitboard king_attacks(int index) noexcept { return KingAttackTable[index]; }
+constexpr Bitboard king_attacks(Coord c) noexcept { return king_attacks(square_index(c)); }
+
+// Squares attacked by a pawn of player `p` standing on the square.
+constexpr Bitboard pawn_attacks_from(Player p, int index) noexcept { return PawnAttackTable[is_white(p) ? 0 : 1][index]; }
+
+inline Bitboard ray_attacks(Direction dir, int index, Bitboard occupied) noexcept {
+    const auto ray = ray_mask(dir, index);
+    const auto blockers = ray & occupied;
+    return blockers ? ray ^ ray_mask(dir, nearest_on_ray(dir, blockers)) : ray;
+}
+
+inline Bitboard bishop_attacks(int index, Bitboard occupied) noexcept {
+    return ray_attacks(SouthWest, index, occupied) | ray_attacks(SouthEast, index, occupied) |
+        ray_attacks(NorthWest, index, occupied) | ray_attacks(NorthEast, index, occupied);
+}
+inline Bitboard bishop_attacks(Coord c, Bitboard occupied) noexcept { return bishop_attacks(square_index(c), occupied); }
+
+inline Bitboard rook_attacks(int index, Bitboard occupied) noexcept {
+    return ray_attacks(South, index, occupied) | ray_attacks(West, index, occupied) |
+        ray_attacks(East, index, occupied) | ray_attacks(North, index, occupied);
+}
+inline Bitboard rook_attacks(Coord c, Bitboard occupied) noexcept { return rook_attacks(square_index(c), occupied); }
+
+inline Bitboard queen_attacks(Coord c, Bitboard occupied) noexcept {
+    return bishop_attacks(c, occupied) | rook_attacks(c, occupied);
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
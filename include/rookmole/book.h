@@ -0,0 +1,81 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#pragma once
+
+#include "rookmole/mapped_file.h"
+#include "rookmole/pgn.h"
+#include "rookmole/state.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Opening book: a file of 16-byte entries (Zobrist key, move, weight) sorted by the key, after a 16-byte header
+// (magic "RMBK", version, entry count). The file is memory-mapped and the moves of a position are found with a
+// binary search, without any heap allocation.
+
+struct BookMove {
+    MoveCoord move;
+    uint32_t weight = 0;
+};
+
+class OpeningBook {
+    MappedFile _file;
+    const uint8_t* _entries = nullptr;
+    uint64_t _entry_count = 0;
+    bool _valid = false;
+
+public:
+    OpeningBook() noexcept = default;
+    explicit OpeningBook(const std::string& path);
+
+    bool is_open() const noexcept { return _valid; }
+    uint64_t size() const noexcept { return _entry_count; }
+
+    // Copies up to `capacity` moves of the position, and returns the number of moves in the book.
+    size_t probe(const GameState& s, BookMove* moves, size_t capacity) const noexcept;
+
+    // The move with the greatest weight, as played by the search.
+    std::optional<MoveCoord> best_move(const GameState& s) const noexcept;
+
+    // A move picked with a probability proportional to its weight, given a uniformly distributed random number.
+    std::optional<MoveCoord> pick_move(const GameState& s, uint64_t random) const noexcept;
+};
+
+// Aggregates the moves played in a corpus of games. A move scores 2 for each win of the side that played it and 1
+// for each draw or game with an unknown result; moves of lost games are not counted.
+class OpeningBookBuilder {
+    struct Entry {
+        uint64_t key;
+        uint16_t move;
+        uint32_t weight;
+    };
+    std::vector<Entry> _entries;
+
+public:
+    void add(const GameState& s, MoveCoord move, uint32_t weight);
+    void add_game(const PgnGame& game, int max_plies);
+
+    // Merges the duplicates and writes the book, leaving out moves weighing less than `min_weight`.
+    bool write(const std::string& path, uint32_t min_weight = 1);
+};
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
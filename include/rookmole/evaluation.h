@@ -13,13 +13,68 @@
 #pragma once
 
 #include "rookmole/state.h"
+#include <cstddef>
 
 namespace rookmole {
 
 //=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
 
+// Probe and hit counters of a hash table.
+struct HashTableStats {
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+
+    double hit_rate() const noexcept { return probes != 0 ? static_cast<double>(hits) / static_cast<double>(probes) : 0.0; }
+};
+
+inline HashTableStats operator-(HashTableStats a, HashTableStats b) noexcept { return {a.probes - b.probes, a.hits - b.hits}; }
+inline HashTableStats operator+(HashTableStats a, HashTableStats b) noexcept { return {a.probes + b.probes, a.hits + b.hits}; }
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// The score of a checkmate, from the perspective of the winner.
+constexpr int MateValue = 1000000;
+
 int evaluate_hardcode(Player eval_player, const GameNode& node) noexcept;
 
+// Checkmate, stalemate and `evaluate_material` only: a baseline to measure the positional terms against.
+int evaluate_basic(Player eval_player, const GameNode& node) noexcept;
+
+// Material and piece-square terms of `evaluate_hardcode`, i.e. the part which depends on piece placement only.
+int evaluate_material(Player eval_player, const GameState& state) noexcept;
+
+// Computes `evaluate_material` for `count` independent positions at once.
+// The boards are transposed into a structure-of-arrays layout, so that the piece-square lookups are performed
+// with SIMD across positions. Produces exactly the same scores as the scalar function.
+void evaluate_batch(Player eval_player, const GameState* states, int* scores, size_t count) noexcept;
+
+// Doubled, isolated, backward and passed pawn terms of `evaluate_hardcode`.
+// The results are cached in a per-thread pawn hash table keyed by the pawn-only Zobrist key.
+int evaluate_pawn_structure(Player eval_player, const GameState& state) noexcept;
+
+// Counters of the pawn hash table of the calling thread.
+HashTableStats pawn_hash_stats() noexcept;
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Evaluation cache: a lossy, direct-mapped table of `evaluate_hardcode` scores keyed by the Zobrist key of the
+// position. It is shared by all threads; entries are written without locks and verified on read, so a torn entry
+// is seen as a miss.
+
+constexpr int DefaultEvalCacheSizeLog2 = 16;
+
+// Resizes (and clears) the cache to 2^size_log2 entries of 16 bytes. Zero disables the cache.
+// Must not be called while any thread is evaluating. Throws std::bad_alloc, keeping the cache as it was, if the memory
+// cannot be allocated.
+void configure_eval_cache(int size_log2);
+int eval_cache_size_log2() noexcept;
+
+// Same as `evaluate_hardcode`, but consults the evaluation cache first.
+int evaluate_cached(Player eval_player, const GameNode& node) noexcept;
+
+// Counters of the evaluation cache probes made by the calling thread.
+HashTableStats eval_cache_stats() noexcept;
+
 //=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
 
 } // namespace rookmole
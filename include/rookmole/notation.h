@@ -0,0 +1,71 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+#pragma once
+
+#include "rookmole/state.h"
+
+#include <array>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Long algebraic notation of the UCI protocol, e.g. "e2e4", "e1g1" (castling) or "e7e8q" (promotion).
+// Pawns are always promoted to queens, so other promotion suffixes are rejected.
+
+std::string to_uci_move(const GameState& s, MoveCoord m);
+std::optional<MoveCoord> parse_uci_move(const GameState& s, std::string_view text);  // Legal moves only.
+
+// Space-separated moves of a line played from `s`.
+std::string to_uci_line(GameState s, const MoveCoordVec& moves);
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Standard algebraic notation (SAN), e.g. "Nf3", "exd5", "Rad1", "O-O" or "e8=Q+".
+// Parsing ignores check and annotation suffixes, and resolves the move without generating all the legal moves:
+// only the pieces which can reach the destination square are tried.
+
+std::string to_san_move(const GameState& s, MoveCoord m);
+std::optional<MoveCoord> parse_san_move(const GameState& s, std::string_view text);
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Forsyth-Edwards Notation (FEN), e.g. "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1".
+// The fullmove number maps to `move_count + 1`. The halfmove clock is not a part of the state: it must be a number when
+// parsed, but is not kept, and is written as 0. The counters may be omitted altogether, as in EPD.
+// Positions the move generator cannot handle are rejected: without exactly one king per side, with pawns on the first
+// or the last rank, or with the player not to move in check.
+// Neither function allocates; `to_fen` writes into the buffer and returns a view of it.
+
+using FenBuffer = std::array<char, 96>;
+
+std::optional<GameState> parse_fen(std::string_view text) noexcept;
+std::string_view to_fen(const GameState& s, FenBuffer& buffer) noexcept;
+inline std::string to_fen(const GameState& s) { auto buffer = FenBuffer{}; return std::string{to_fen(s, buffer)}; }
+
+// Extended Position Description (EPD): the first four FEN fields followed by operations, e.g.
+// `r1b1k2r/ppppnppp/2n2q2/2b5/3NP3/2P1B3/PP3PPP/RN1QKB1R w KQkq - bm Nb5; id "test.001";`
+// Only the "bm" (best moves), "am" (avoid moves) and "id" operations are interpreted.
+
+struct EpdRecord {
+    GameState state;
+    MoveCoordVec best_moves;
+    MoveCoordVec avoid_moves;
+    std::string id;
+};
+
+std::optional<EpdRecord> parse_epd(std::string_view line);
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
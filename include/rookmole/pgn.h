@@ -0,0 +1,62 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#pragma once
+
+#include "rookmole/state.h"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// A game replayed from PGN movetext: `moves[i]` leads from `states[i]` to `states[i + 1]`.
+struct PgnGame {
+    std::vector<GameState> states;
+    MoveCoordVec moves;
+    GameResult result = GameResult::Unknown;
+};
+
+struct PgnReplayStats {
+    uint64_t games = 0;          // Games replayed and passed to the callback.
+    uint64_t skipped_games = 0;  // Games with an illegal or unsupported move, or an invalid FEN tag.
+    uint64_t positions = 0;      // Positions of the replayed games, including the initial ones.
+
+    PgnReplayStats& operator+=(const PgnReplayStats& other) noexcept {
+        games += other.games;
+        skipped_games += other.skipped_games;
+        positions += other.positions;
+        return *this;
+    }
+};
+
+// Invoked concurrently from the worker threads. The game is only valid for the duration of the call.
+using PgnGameCallback = std::function<void(const PgnGame&)>;
+
+// Replays all the games of a PGN text, split at game boundaries among `thread_count` worker threads
+// (0 stands for one per hardware thread). Comments, variations and NAGs are skipped.
+// Games are reported in no particular order.
+PgnReplayStats replay_pgn(std::string_view text, int thread_count, const PgnGameCallback& on_game);
+
+// Replays a memory-mapped PGN file. Returns nullopt if the file cannot be opened.
+std::optional<PgnReplayStats> replay_pgn_file(const std::string& path, int thread_count, const PgnGameCallback& on_game);
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
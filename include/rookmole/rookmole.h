@@ -13,5 +13,18 @@
 #pragma once
 
 #include "rookmole/alphabeta.h"
+#include "rookmole/benchmark.h"
+#include "rookmole/bitboard.h"
+#include "rookmole/book.h"
 #include "rookmole/state.h"
 #include "rookmole/evaluation.h"
+#include "rookmole/mapped_file.h"
+#include "rookmole/notation.h"
+#include "rookmole/pgn.h"
+#include "rookmole/search.h"
+#include "rookmole/see.h"
+#include "rookmole/tablebase.h"
+#include "rookmole/thread_pool.h"
+#include "rookmole/trace.h"
+#include "rookmole/training_data.h"
+#include "rookmole/zobrist.h"
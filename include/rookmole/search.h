@@ -0,0 +1,64 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+#pragma once
+
+#include "rookmole/alphabeta.h"
+#include <functional>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Iterative deepening: https://www.chessprogramming.org/Iterative_Deepening
+// Searches the root to increasing depths, each iteration trying the previous principal variation first, until a
+// limit or a signal stops it. The first iteration always completes, so that there is a move to play.
+// With several threads, each iteration searches the first root move alone to establish a bound, and then splits the
+// remaining root moves among the threads.
+// If the root is in the opening book of the options, the book move is returned at depth 0 instead.
+
+struct SearchLimits {
+    int depth = MaxSearchDepth;
+    uint64_t nodes = 0;  // 0: unlimited. With several threads, this is the limit of each one.
+    int threads = 1;
+};
+
+// The outcome of the last completed iteration.
+struct SearchReport {
+    MoveCoord move;     // Invalid if the root is terminal.
+    int value = 0;      // From the perspective of the player to move at the root.
+    int depth = 0;
+    uint64_t nodes = 0; // Including the nodes of an abandoned iteration.
+    std::chrono::microseconds time{0};
+    MoveCoordVec pv;
+    SearchStats stats;
+
+    uint64_t nps() const noexcept { return time.count() > 0 ? nodes * 1000000 / time.count() : 0; }
+};
+
+using SearchReportCallback = std::function<void(const SearchReport&)>;
+
+SearchReport search(const GameNode& root, const SearchLimits& limits, const SearchSignals& signals,
+    const SearchOptions& options, const SearchReportCallback& on_iteration = {});
+
+inline SearchReport search(const GameNode& root, const SearchLimits& limits, const SearchSignals& signals,
+    const SearchReportCallback& on_iteration = {})
+{
+    return search(root, limits, signals, SearchOptions{}, on_iteration);
+}
+
+// The distance to mate in moves (negative if the player to move is getting mated), or 0 for other values.
+int mate_in_moves(int value) noexcept;
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
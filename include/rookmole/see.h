@@ -0,0 +1,43 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+#pragma once
+
+#include "rookmole/bitboard.h"
+#include "rookmole/state.h"
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Static exchange evaluation: https://www.chessprogramming.org/Static_Exchange_Evaluation
+
+// Material values of the pieces in an exchange, indexed by `Piece`. The king outweighs any exchange, so that it only
+// captures last.
+constexpr int SeeValues[] = {0, 100, 300, 320, 500, 800, 20000};
+
+// The material won by move `m` alone: the value of the piece it captures, and of the promotion.
+int capture_gain(const GameState& s, Move m) noexcept;
+
+// The material won by the player to move with move `m` (a legal move of `s`), when both players go on capturing on
+// its target square with their least valuable pieces for as long as it pays off. Pieces uncovered behind the capturing
+// ones (x-rays) join in. Pins and checks are ignored, as are the promotions beyond `m` itself.
+int see(const GameState& s, Move m) noexcept;
+int see(const GameState& s, const Bitboards& bbs, Move m) noexcept;  // With `make_bitboards(s)` at hand.
+
+// Whether `see(s, m) >= threshold`, without resolving the exchange where the material of the first capture decides.
+bool see_ge(const GameState& s, Move m, int threshold) noexcept;
+bool see_ge(const GameState& s, const Bitboards& bbs, Move m, int threshold) noexcept;
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
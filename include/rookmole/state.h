@@ -17,6 +17,7 @@
 #include <cassert>
 #include <cstdint>
 #include <iostream>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -70,6 +71,10 @@ constexpr bool is_valid(Coord c) noexcept { return c.file >= 1 && c.file <= 8 &&
 constexpr bool is_invalid(Coord c) noexcept { return !is_valid(c); }
 constexpr Coord other_player(Coord c) noexcept { assert(is_valid(c)); return Coord{9 - c.file, 9 - c.rank}; }
 
+// The squares indexed as the nibbles of `GameState::squares`: a1 is 0, h1 is 7 and h8 is 63.
+constexpr int square_index(Coord c) noexcept { assert(is_valid(c)); return 8 * (c.rank - 1) + (c.file - 1); }
+constexpr Coord coord_of(int index) noexcept { assert(index >= 0 && index < 64); return Coord{index % 8 + 1, index / 8 + 1}; }
+
 template<bool reverse = false>
 constexpr Coord make_coord(std::string_view text) noexcept {
     return !reverse ? Coord{text} : other_player(Coord{text});
@@ -188,9 +193,14 @@ struct GameState {
 
     Square get_square(Coord coord) const noexcept {
         assert(is_valid(coord));
-        const auto sq_index = 8 * coord.rank + coord.file - 9;
-        const bool high_nibble = sq_index % 2;
-        const auto tsq = squares[sq_index / 2];
+        return square_at(8 * coord.rank + coord.file - 9);
+    }
+
+    // By `square_index`.
+    Square square_at(int index) const noexcept {
+        assert(index >= 0 && index < 64);
+        const bool high_nibble = index % 2;
+        const auto tsq = squares[index / 2];
         return static_cast<Square>(high_nibble ? tsq >> 4 : tsq & 0x0F);
     }
 
@@ -240,6 +250,76 @@ std::ostream& operator<<(std::ostream& out, const GameState& state);
 
 //=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
 
+// The kind of a move, so that making it needs no look at the board to tell castling, en passant and promotion apart.
+// Bit 2 marks the captures, and bit 3 the promotions (always to a queen).
+enum class MoveFlag : uint8_t {
+    Quiet            = 0,
+    DoublePush       = 1,
+    KingCastling     = 2,  // Towards the h-file.
+    QueenCastling    = 3,  // Towards the a-file.
+    Capture          = 4,
+    EnPassant        = 5,
+    Promotion        = 8,
+    PromotionCapture = 12,
+};
+
+// A move packed into 16 bits: the squares from and to (see `square_index`) in 6 bits each, and the flag in 4 bits.
+// Used by the move generation and the search; `MoveCoord` remains the move of the public interface.
+class Move {
+    uint16_t _bits = 0;
+
+public:
+    constexpr Move() noexcept = default;
+    constexpr Move(int from, int to, MoveFlag flag) noexcept :
+        _bits{static_cast<uint16_t>(from | (to << 6) | (static_cast<int>(flag) << 12))}
+    {
+        assert(from >= 0 && from < 64 && to >= 0 && to < 64);
+    }
+    constexpr Move(Coord from, Coord to, MoveFlag flag) noexcept : Move{square_index(from), square_index(to), flag} {}
+
+    constexpr int from() const noexcept { return _bits & 0x3F; }
+    constexpr int to() const noexcept { return (_bits >> 6) & 0x3F; }
+    constexpr MoveFlag flag() const noexcept { return static_cast<MoveFlag>(_bits >> 12); }
+    constexpr uint16_t bits() const noexcept { return _bits; }
+
+    constexpr bool is_capture() const noexcept { return (_bits >> 12) & 0b0100; }
+    constexpr bool is_promotion() const noexcept { return (_bits >> 12) & 0b1000; }
+    constexpr bool is_castling() const noexcept { return flag() == MoveFlag::KingCastling || flag() == MoveFlag::QueenCastling; }
+};
+
+static_assert(sizeof(Move) == 2);
+
+constexpr bool operator==(Move m0, Move m1) noexcept { return m0.bits() == m1.bits(); }
+constexpr bool operator!=(Move m0, Move m1) noexcept { return !(m0 == m1); }
+
+constexpr MoveCoord to_move_coord(Move m) noexcept { return {coord_of(m.from()), coord_of(m.to())}; }
+Move to_move(const GameState& s, MoveCoord mc) noexcept;  // Tells the flag of a legal move of `s` from the board.
+
+inline std::ostream& operator<<(std::ostream& out, Move m) { return out << to_move_coord(m); }
+
+constexpr size_t MaxLegalMoves = 256;  // The most known for a legal position is 218.
+
+// A list of moves of a fixed capacity, filled without allocating, e.g. by the search at every node.
+class MoveList {
+    std::array<Move, MaxLegalMoves> _moves;
+    size_t _size = 0;
+
+public:
+    void clear() noexcept { _size = 0; }
+    void push_back(Move move) noexcept {
+        assert(_size < MaxLegalMoves);
+        _moves[_size++] = move;
+    }
+
+    size_t size() const noexcept { return _size; }
+    bool empty() const noexcept { return _size == 0; }
+    Move operator[](size_t i) const noexcept { assert(i < _size); return _moves[i]; }
+    const Move* begin() const noexcept { return _moves.data(); }
+    const Move* end() const noexcept { return _moves.data() + _size; }
+};
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
 class ScopedPieceMover {
     GameState& _state;
     MoveCoord _move_coord;
@@ -266,38 +346,6 @@ public:
 
 //=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
 
-template<typename CbT>
-void foreach_vicinity(Coord c, const CbT& cb) {
-    assert(is_valid(c));
-    constexpr Coord offs[] = { {-1,-1}, {0, -1}, {1, -1}, {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1} };
-    for (const auto off : offs) {
-        const auto c_off = c + off;
-        if (is_invalid(c_off)) continue;
-        if (!cb(c_off)) return;
-    }
-}
-
-template<typename CbT>
-void foreach_knight_attack(Coord c, const CbT& cb) {
-    assert(is_valid(c));
-    constexpr Coord offs[] = { {-1, -2}, {1, -2}, {-2, -1}, {2, -1}, {-2, 1}, {2, 1}, {-1, 2}, {1, 2} };
-    for (const auto off : offs) {
-        const auto c_off = c + off;
-        if (is_invalid(c_off)) continue;
-        if (!cb(c_off)) return;
-    }
-}
-
-template<typename CbT>
-void foreach_in_dir(Coord c, Coord dir, const CbT& cb) {
-    assert(is_valid(c));
-    while (true) {
-        c = c + dir;
-        if (is_invalid(c)) return;
-        if (!cb(c)) return;
-    }
-}
-
 bool is_attacked_by(Player p, Coord c, const GameState& s) noexcept;
 inline bool is_attacked_by_him(Coord c, const GameState& s) noexcept {
     return is_attacked_by(other_player(s.player_to_move), c, s);
@@ -306,18 +354,66 @@ inline bool is_attacked_by_him(Coord c, const GameState& s) noexcept {
 Coord find_king(Player p, const GameState& s) noexcept;
 inline Coord find_my_king(const GameState& s) noexcept { return find_king(s.player_to_move, s); }
 MoveCoordVec get_legal_moves(const GameState& s);
+void get_legal_moves(const GameState& s, MoveList& out) noexcept;  // Replaces the contents of `out`.
+
+// The subsets of the legal moves, for the stages of the search. The captures and the quiet moves make all the legal
+// moves, as do the evasions of a player in check.
+enum class MoveGenMode : uint8_t {
+    Legal,
+    Captures,     // Including en passant, and all the promotions.
+    Quiets,       // Neither capturing nor promoting, castling included.
+    Evasions,     // All the legal moves; other than the king's, only those capturing or blocking the checking piece.
+    QuietChecks,  // The quiet moves checking the opponent.
+};
+
+template<Player player, MoveGenMode mode = MoveGenMode::Legal>
+void get_legal_moves(const GameState& s, MoveList& out) noexcept;  // `player` is to move.
+
+template<MoveGenMode mode>
+void get_legal_moves(const GameState& s, MoveList& out) noexcept {
+    if (is_white(s.player_to_move)) get_legal_moves<Player::White, mode>(s, out);
+    else get_legal_moves<Player::Black, mode>(s, out);
+}
+bool has_any_legal_move(const GameState& s) noexcept;  // Stops at the first legal move found.
+bool is_king_in_check(const GameState& s) noexcept;     // Whether the king of the player to move is attacked.
 
 //=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
 
-struct GameNode {
+// A game state with its properties derived on first access and memoized.
+// Not thread-safe: a node must not be queried from several threads at once.
+class GameNode {
+    mutable std::optional<MoveCoordVec> _next_moves;
+    mutable std::optional<bool> _king_in_check;
+    mutable std::optional<bool> _has_any_legal_move;
+
+public:
     GameState state;
-    MoveCoordVec next_moves;
-    bool king_in_check;
+
+    GameNode() noexcept = default;
+    explicit GameNode(const GameState& state_) noexcept : state{state_} {}
+
+    const MoveCoordVec& next_moves() const;
+    bool king_in_check() const noexcept;
+    bool has_any_legal_move() const noexcept;
 };
 
 GameNode make_start_node();
+GameNode make_move(GameState s, Move m) noexcept;
+template<Player player> GameNode make_move(GameState s, Move m) noexcept;  // `player` is to move.
 GameNode make_move(GameState s, MoveCoord m);
-bool is_terminal(GameNode n) noexcept;
+bool is_terminal(const GameNode& n) noexcept;
+
+// Counts the leaves of the tree of legal moves of the given depth, to be compared with the known counts of the test
+// positions: https://www.chessprogramming.org/Perft_Results (the counts which involve underpromotions excepted).
+// Does not allocate.
+uint64_t perft(const GameState& s, int depth) noexcept;
+
+enum class GameResult : uint8_t {
+    Unknown  = 0,
+    WhiteWon = 1,
+    BlackWon = 2,
+    Draw     = 3
+};
 
 //=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
 
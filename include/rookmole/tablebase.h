@@ -0,0 +1,107 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#pragma once
+
+#include "rookmole/mapped_file.h"
+#include "rookmole/state.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Distance-to-mate endgame tablebases, generated by retrograde analysis.
+//
+// A table covers one material signature, e.g. "KRKP": the white pieces up to the second king, then the black ones.
+// Positions with the colors reversed are probed with the board mirrored. A table holds one byte per position,
+// indexed by the squares of its pieces (in the order of the signature) and the player to move:
+//   0       - a draw,
+//   1..254  - the distance to mate in plies, plus one; an odd distance is a win of the player to move,
+//   255     - an illegal position.
+// Castling and en passant are not modelled, neither is the 80-move limit of `is_terminal`.
+//
+// Files (<signature>.rmtb) hold a 16-byte header (magic "RMTB", version, signature) followed by the raw table,
+// and are memory-mapped when loaded.
+
+constexpr int MaxTablebasePieces = 4;
+constexpr int MaxTablebaseMatePlies = 253;  // The longest distance to mate a table can hold.
+
+// The signatures `rookmole.tbgen` builds, each after the tables it depends on.
+constexpr std::array<std::string_view, 6> TablebaseSignatures = {"KQK", "KRK", "KPK", "KBNK", "KQKR", "KRKP"};
+
+enum class TablebaseWdl : int8_t {
+    Loss = -1,
+    Draw = 0,
+    Win = 1,
+};
+
+// The result for the player to move.
+struct TablebaseProbe {
+    TablebaseWdl wdl = TablebaseWdl::Draw;
+    int plies = 0;  // The distance to mate, if not a draw.
+};
+
+struct TablebaseStats {
+    uint64_t positions = 0;  // Legal ones.
+    uint64_t wins = 0;
+    uint64_t draws = 0;
+    uint64_t losses = 0;
+    int longest_mate = 0;  // In plies.
+};
+
+class Tablebases {
+    struct Table {
+        std::string signature;
+        MappedFile file;
+        std::vector<uint8_t> owned;
+        const uint8_t* values = nullptr;
+        size_t size = 0;
+    };
+    std::vector<Table> _tables;
+
+    const Table* find(std::string_view signature) const noexcept;
+
+public:
+    size_t size() const noexcept { return _tables.size(); }
+    bool has(std::string_view signature) const noexcept { return find(signature) != nullptr; }
+
+    // Maps the table of a signature from a directory. Fails if the file is missing or malformed.
+    bool load(const std::string& directory, std::string_view signature);
+
+    // Maps every table of `TablebaseSignatures` found in a directory, and returns the number of them.
+    int load_all(const std::string& directory);
+
+    // Builds a table in memory. The tables reached by captures and promotions must be present already, except for
+    // the trivially drawn ones (bare kings and a single minor piece).
+    bool generate(std::string_view signature, int thread_count = 0);
+
+    bool write(const std::string& directory, std::string_view signature) const;
+
+    std::optional<TablebaseStats> stats(std::string_view signature) const noexcept;
+
+    // The exact result of a position, if its material is covered.
+    std::optional<TablebaseProbe> probe(const GameState& s) const noexcept;
+};
+
+std::string tablebase_file_name(std::string_view signature);
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
@@ -0,0 +1,97 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Event timeline of the threads, in the Chrome Trace format (chrome://tracing, https://ui.perfetto.dev).
+//
+// Each thread records timestamped events into its own ring buffer, keeping the latest ones, without locks.
+// The events are emitted only in builds with ROOKMOLE_TRACE defined (the CMake option of the same name), and only
+// between `start_tracing` and `stop_tracing`; otherwise the calls below compile to nothing.
+// Event names must be string literals, as only the pointers are kept.
+
+#if defined(ROOKMOLE_TRACE)
+constexpr bool TracingEnabled = true;
+#else
+constexpr bool TracingEnabled = false;
+#endif
+
+void start_tracing() noexcept;  // Also drops the events recorded before.
+void stop_tracing() noexcept;
+bool is_tracing() noexcept;
+
+// Writes the recorded events. Meant to be called once tracing is stopped; events being recorded meanwhile may be
+// written torn.
+bool write_chrome_trace(const std::string& path);
+
+void record_trace_event(const char* name, int64_t start_nsec, int64_t duration_nsec, int64_t arg) noexcept;
+void record_trace_instant(const char* name, int64_t arg) noexcept;
+void set_trace_thread_name(const char* name) noexcept;
+
+inline int64_t trace_clock_nsec() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// A point in time, e.g. a work item taken by a thread.
+inline void trace_instant(const char* name, int64_t arg = 0) noexcept {
+    if constexpr (TracingEnabled) {
+        if (is_tracing()) record_trace_instant(name, arg);
+    }
+}
+
+// Names the calling thread in the timeline.
+inline void trace_thread_name(const char* name) noexcept {
+    if constexpr (TracingEnabled) {
+        set_trace_thread_name(name);
+    }
+}
+
+// A span covering its scope.
+class TraceScope {
+    const char* _name = nullptr;
+    int64_t _arg = 0;
+    int64_t _start_time = 0;
+
+public:
+    explicit TraceScope(const char* name, int64_t arg = 0) noexcept {
+        if constexpr (TracingEnabled) {
+            if (is_tracing()) {
+                _name = name;
+                _arg = arg;
+                _start_time = trace_clock_nsec();
+            }
+        }
+    }
+
+    ~TraceScope() {
+        if constexpr (TracingEnabled) {
+            if (_name) record_trace_event(_name, _start_time, trace_clock_nsec() - _start_time, _arg);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
@@ -0,0 +1,113 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#pragma once
+
+#include "rookmole/mapped_file.h"
+#include "rookmole/state.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Training data: a binary file of fixed-size records, each holding a position with its search score, the result of
+// the game it was played in and the best move found.
+//
+// The file starts with a 32-byte header (magic "RMTD", version, flags, record size, records per block). Records are
+// grouped in blocks. In an uncompressed file they simply follow the header, so a record is located by its index
+// alone. In a compressed file each block is stored as its byte size followed by the compressed bytes. Compression
+// XORs each record with the previous one and then encodes runs of zero bytes. A footer with the offsets of all
+// the blocks allows random access.
+
+struct TrainingRecord {
+    GameState state;
+    int16_t score = 0;  // From the perspective of the player to move; see `to_training_score`.
+    GameResult result = GameResult::Unknown;
+    MoveCoord best_move;  // Invalid if there is none.
+};
+
+// Clamps a search value into the 16-bit range: mate scores become ±TrainingMateScore.
+constexpr int16_t TrainingMateScore = 32000;
+int16_t to_training_score(int value) noexcept;
+
+constexpr uint16_t TrainingDataVersion = 1;
+constexpr size_t TrainingRecordSize = 40;
+constexpr uint32_t TrainingBlockRecords = 4096;
+
+using PackedTrainingRecord = std::array<uint8_t, TrainingRecordSize>;
+PackedTrainingRecord pack(const TrainingRecord& record) noexcept;
+TrainingRecord unpack(const uint8_t* packed) noexcept;
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Appends records to a new file, a block at a time. Not thread-safe.
+class TrainingDataWriter {
+    std::FILE* _file = nullptr;
+    bool _compress = false;
+    bool _failed = false;
+    uint64_t _record_count = 0;
+    std::vector<uint8_t> _block;           // Packed records of the current block.
+    std::vector<uint8_t> _compressed;
+    std::vector<uint64_t> _block_offsets;  // Compressed files only.
+    uint64_t _offset = 0;
+
+    void write_bytes(const void* data, size_t size) noexcept;
+    void flush_block();
+
+public:
+    TrainingDataWriter(const std::string& path, bool compress);
+    TrainingDataWriter(const TrainingDataWriter&) = delete;
+    TrainingDataWriter& operator=(const TrainingDataWriter&) = delete;
+    ~TrainingDataWriter();
+
+    bool is_open() const noexcept { return _file != nullptr; }
+    uint64_t record_count() const noexcept { return _record_count; }
+
+    void write(const TrainingRecord& record);
+    bool close();  // Writes the last block and the footer. False if any write failed.
+};
+
+// Random access to the records of a memory-mapped file. Keeps the last decompressed block, so it is not
+// thread-safe: use one reader per thread.
+class TrainingDataReader {
+    MappedFile _file;
+    bool _valid = false;
+    bool _compressed = false;
+    uint64_t _record_count = 0;
+    const uint8_t* _records = nullptr;     // Uncompressed files only.
+    const uint8_t* _block_offsets = nullptr;
+    uint64_t _block_count = 0;
+    uint64_t _cached_block = UINT64_MAX;
+    std::vector<uint8_t> _block;
+
+    bool load_block(uint64_t block_index);
+
+public:
+    explicit TrainingDataReader(const std::string& path);
+
+    bool is_open() const noexcept { return _valid; }
+    bool is_compressed() const noexcept { return _compressed; }
+    uint64_t size() const noexcept { return _record_count; }
+
+    TrainingRecord read(uint64_t index);
+};
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
@@ -12,10 +12,60 @@
 
 #include "rookmole/alphabeta.h"
 
+#include <sstream>
+
 namespace rookmole {
 
 //=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
 
+SearchStats& SearchStats::operator+=(const SearchStats& other) noexcept
+{
+    nodes += other.nodes;
+    pawn_hash = pawn_hash + other.pawn_hash;
+    eval_cache = eval_cache + other.eval_cache;
+    leaf_nodes += other.leaf_nodes;
+    quiescence_nodes += other.quiescence_nodes;
+    cutoffs += other.cutoffs;
+    first_move_cutoffs += other.first_move_cutoffs;
+    for (size_t ply = 0; ply < nodes_by_ply.size(); ++ply) {
+        nodes_by_ply[ply] += other.nodes_by_ply[ply];
+    }
+    movegen_nsec += other.movegen_nsec;
+    eval_nsec += other.eval_nsec;
+    return *this;
+}
+
+std::string to_json(const SearchStats& stats)
+{
+    const auto hash_table_json = [](const HashTableStats& hts) {
+        return "{\"probes\": " + std::to_string(hts.probes) + ", \"hits\": " + std::to_string(hts.hits) + "}";
+    };
+
+    auto out = std::ostringstream{};
+    out << "{\"enabled\": " << (SearchStatsEnabled ? "true" : "false") <<
+        ", \"nodes\": " << stats.nodes <<
+        ", \"pawn_hash\": " << hash_table_json(stats.pawn_hash) <<
+        ", \"eval_cache\": " << hash_table_json(stats.eval_cache);
+    if constexpr (SearchStatsEnabled) {
+        out << ", \"leaf_nodes\": " << stats.leaf_nodes <<
+            ", \"quiescence_nodes\": " << stats.quiescence_nodes <<
+            ", \"cutoffs\": " << stats.cutoffs <<
+            ", \"first_move_cutoffs\": " << stats.first_move_cutoffs <<
+            ", \"first_move_cutoff_rate\": " << stats.first_move_cutoff_rate() <<
+            ", \"movegen_nsec\": " << stats.movegen_nsec <<
+            ", \"eval_nsec\": " << stats.eval_nsec <<
+            ", \"nodes_by_ply\": [";
+        auto ply_count = stats.nodes_by_ply.size();
+        while (ply_count > 0 && stats.nodes_by_ply[ply_count - 1] == 0) --ply_count;
+        for (size_t ply = 0; ply < ply_count; ++ply) {
+            out << (ply ? ", " : "") << stats.nodes_by_ply[ply];
+        }
+        out << "]";
+    }
+    out << "}";
+    return out.str();
+}
+
 //=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
 
 } // namespace rookmole
@@ -0,0 +1,177 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#include "rookmole/book.h"
+#include "rookmole/zobrist.h"
+#include "little_endian.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+namespace {
+
+constexpr char BookMagic[4] = {'R', 'M', 'B', 'K'};
+constexpr uint32_t BookVersion = 1;
+constexpr size_t BookHeaderSize = 16;
+constexpr size_t BookEntrySize = 16;
+
+// Moves are stored as two 6-bit square indices.
+uint16_t encode_move(MoveCoord m) noexcept {
+    return static_cast<uint16_t>(square_index(m.from) | (square_index(m.to) << 6));
+}
+
+MoveCoord decode_move(uint16_t code) noexcept {
+    return MoveCoord{coord_of(code & 63), coord_of((code >> 6) & 63)};
+}
+
+} // namespace
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+OpeningBook::OpeningBook(const std::string& path) :
+    _file{path}
+{
+    if (!_file.is_open() || _file.size() < BookHeaderSize) return;
+    const auto* data = reinterpret_cast<const uint8_t*>(_file.data());
+    if (!std::equal(std::begin(BookMagic), std::end(BookMagic), data)) return;
+    if (load_le<uint32_t>(data + 4) != BookVersion) return;
+
+    _entry_count = load_le<uint64_t>(data + 8);
+    if (_entry_count > (_file.size() - BookHeaderSize) / BookEntrySize) return;
+    _entries = data + BookHeaderSize;
+    _valid = true;
+}
+
+size_t OpeningBook::probe(const GameState& s, BookMove* moves, size_t capacity) const noexcept
+{
+    if (!_valid) return 0;
+    const uint64_t key = zobrist_key(s);
+
+    // The first entry with the key.
+    uint64_t first = 0;
+    uint64_t count = _entry_count;
+    while (count > 0) {
+        const uint64_t half = count / 2;
+        if (load_le<uint64_t>(_entries + (first + half) * BookEntrySize) < key) {
+            first += half + 1;
+            count -= half + 1;
+        }
+        else {
+            count = half;
+        }
+    }
+
+    size_t found = 0;
+    for (uint64_t i = first; i < _entry_count; ++i) {
+        const auto* entry = _entries + i * BookEntrySize;
+        if (load_le<uint64_t>(entry) != key) break;
+        if (found < capacity) {
+            moves[found].move = decode_move(load_le<uint16_t>(entry + 8));
+            moves[found].weight = load_le<uint32_t>(entry + 10);
+        }
+        ++found;
+    }
+    return found;
+}
+
+std::optional<MoveCoord> OpeningBook::best_move(const GameState& s) const noexcept
+{
+    BookMove moves[64];
+    const size_t count = std::min(probe(s, moves, std::size(moves)), std::size(moves));
+    if (count == 0) return std::nullopt;
+    return std::max_element(moves, moves + count, [](const BookMove& a, const BookMove& b) { return a.weight < b.weight; })->move;
+}
+
+std::optional<MoveCoord> OpeningBook::pick_move(const GameState& s, uint64_t random) const noexcept
+{
+    BookMove moves[64];
+    const size_t count = std::min(probe(s, moves, std::size(moves)), std::size(moves));
+    uint64_t total_weight = 0;
+    for (size_t i = 0; i < count; ++i) total_weight += moves[i].weight;
+    if (total_weight == 0) return std::nullopt;
+
+    uint64_t r = random % total_weight;
+    for (size_t i = 0; i < count; ++i) {
+        if (r < moves[i].weight) return moves[i].move;
+        r -= moves[i].weight;
+    }
+    return std::nullopt;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+void OpeningBookBuilder::add(const GameState& s, MoveCoord move, uint32_t weight)
+{
+    _entries.push_back(Entry{zobrist_key(s), encode_move(move), weight});
+}
+
+void OpeningBookBuilder::add_game(const PgnGame& game, int max_plies)
+{
+    const size_t plies = std::min(game.moves.size(), static_cast<size_t>(std::max(max_plies, 0)));
+    for (size_t i = 0; i < plies; ++i) {
+        const auto& s = game.states[i];
+        uint32_t weight = 1;
+        if (game.result == GameResult::WhiteWon) weight = is_white(s.player_to_move) ? 2 : 0;
+        else if (game.result == GameResult::BlackWon) weight = is_black(s.player_to_move) ? 2 : 0;
+        if (weight > 0) add(s, game.moves[i], weight);
+    }
+}
+
+bool OpeningBookBuilder::write(const std::string& path, uint32_t min_weight)
+{
+    std::sort(std::begin(_entries), std::end(_entries), [](const Entry& a, const Entry& b) {
+        return a.key != b.key ? a.key < b.key : a.move < b.move;
+    });
+
+    // Merge the entries of the same move in place.
+    size_t merged_count = 0;
+    for (size_t i = 0; i < _entries.size();) {
+        auto merged = _entries[i];
+        uint64_t weight = 0;
+        for (; i < _entries.size() && _entries[i].key == merged.key && _entries[i].move == merged.move; ++i) {
+            weight += _entries[i].weight;
+        }
+        if (weight < min_weight) continue;
+        merged.weight = static_cast<uint32_t>(std::min<uint64_t>(weight, std::numeric_limits<uint32_t>::max()));
+        _entries[merged_count++] = merged;
+    }
+    _entries.resize(merged_count);
+
+    auto* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    uint8_t header[BookHeaderSize] = {};
+    std::copy(std::begin(BookMagic), std::end(BookMagic), header);
+    store_le(header + 4, BookVersion);
+    store_le(header + 8, static_cast<uint64_t>(_entries.size()));
+    bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+    for (const auto& e : _entries) {
+        uint8_t entry[BookEntrySize] = {};
+        store_le(entry, e.key);
+        store_le(entry + 8, e.move);
+        store_le(entry + 10, e.weight);
+        ok = ok && std::fwrite(entry, 1, sizeof(entry), file) == sizeof(entry);
+    }
+
+    return std::fclose(file) == 0 && ok;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
@@ -11,75 +11,462 @@
 */
 
 #include "rookmole/evaluation.h"
+#include "rookmole/bitboard.h"
+#include "rookmole/zobrist.h"
+#include <atomic>
+#include <memory>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ROOKMOLE_EVALUATE_BATCH_SSSE3
+#include <tmmintrin.h>
+#endif
 
 namespace rookmole {
 
 //=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
 
-int evaluate_hardcode(Player eval_player, const GameNode& node) noexcept
-{
-    const auto& state = node.state;
-    int score = 0;
+namespace {
 
-    {
-        const auto player_to_move = state.player_to_move;
-        const auto score_mul = (player_to_move == eval_player) ? 1 : -1;
+constexpr int piece_value(Player p, Piece pc, Coord c) noexcept {
+    switch (pc) {
+        case Pawn: {
+            const auto advancement = is_white(p) ? (c.rank - 2) : (7 - c.rank);
+            return 100 + 20 * advancement;
+        }
+        case Knight:    return 300;
+        case Bishop:    return 320;
+        case Rook:      return 500;
+        case Queen:     return 800;
+        default:        return 0;
+    }
+}
 
-        if (node.next_moves.empty()) {
-            if (node.king_in_check) {
-                // Checkmate
-                return -1000000 * score_mul;
-            }
-            else {
-                // Stalemate
-                return 0;  // A draw.
-            }
+// Points of a square nibble (the first index) placed on a square index (the second index, same as nibble order
+// in `GameState::squares`), from the white player's perspective.
+using PieceSquareTable = std::array<std::array<int16_t, 64>, 16>;
+
+constexpr PieceSquareTable make_piece_square_table() noexcept {
+    auto pst = PieceSquareTable{};
+    for (int sq = 0; sq < 16; ++sq) {
+        const auto pc = piece_of(static_cast<Square>(sq));
+        if (pc == Piece::None || pc > Piece::King) continue;
+        const auto p = player_of(static_cast<Square>(sq));
+        for (int i = 0; i < 64; ++i) {
+            const auto points = piece_value(p, pc, Coord{i % 8 + 1, i / 8 + 1});
+            pst[sq][i] = static_cast<int16_t>(is_white(p) ? points : -points);
         }
+    }
+    return pst;
+}
 
-        score += 60 * score_mul;
+constexpr PieceSquareTable piece_square_table = make_piece_square_table();
 
-        if (node.king_in_check) {
-            score += -80;
+// The same table split into low and high bytes, laid out as 16-entry lookup tables per square index.
+struct PieceSquareByteTables {
+    alignas(16) uint8_t low[64][16];
+    alignas(16) uint8_t high[64][16];
+};
+
+constexpr PieceSquareByteTables make_piece_square_byte_tables() noexcept {
+    auto tables = PieceSquareByteTables{};
+    for (int i = 0; i < 64; ++i) {
+        for (int sq = 0; sq < 16; ++sq) {
+            const auto points = static_cast<uint16_t>(piece_square_table[sq][i]);
+            tables.low[i][sq] = static_cast<uint8_t>(points & 0xFF);
+            tables.high[i][sq] = static_cast<uint8_t>(points >> 8);
         }
+    }
+    return tables;
+}
+
+constexpr PieceSquareByteTables piece_square_byte_tables = make_piece_square_byte_tables();
+
+constexpr size_t BatchWidth = 16;
+
+// A structure-of-arrays view of up to `BatchWidth` nibble boards: `packed[j][lane]` is `squares[j]` of the position
+// in the given lane. Unused lanes hold empty boards.
+struct BoardBatch {
+    alignas(16) uint8_t packed[8 * 8 / 2][BatchWidth];
+};
 
-        auto opponent_king_coord = find_king(other_player(node.state.player_to_move), node.state);
-        if (is_attacked_by(node.state.player_to_move, opponent_king_coord, node.state)) {
-            score += 80;
+void transpose(const GameState* states, size_t count, BoardBatch& batch) noexcept {
+    assert(count <= BatchWidth);
+    for (size_t lane = 0; lane < count; ++lane) {
+        const auto& squares = states[lane].squares;
+        for (size_t j = 0; j < squares.size(); ++j) {
+            batch.packed[j][lane] = squares[j];
         }
+    }
+    for (size_t lane = count; lane < BatchWidth; ++lane) {
+        for (auto& packed : batch.packed) {
+            packed[lane] = 0;
+        }
+    }
+}
 
-        score += 4 * node.next_moves.size();
+void accumulate_generic(const BoardBatch& batch, int (&scores)[BatchWidth]) noexcept {
+    for (auto& score : scores) score = 0;
+    for (int j = 0; j < 8 * 8 / 2; ++j) {
+        for (size_t lane = 0; lane < BatchWidth; ++lane) {
+            const auto tsq = batch.packed[j][lane];
+            scores[lane] += piece_square_table[tsq & 0x0F][2 * j] + piece_square_table[tsq >> 4][2 * j + 1];
+        }
     }
+}
+
+#if defined(ROOKMOLE_EVALUATE_BATCH_SSSE3)
+
+// Every `_mm_shuffle_epi8` looks up one square of all 16 positions at once. Partial sums are kept in 16-bit lanes
+// for 16 squares at a time (which cannot overflow) and then widened to 32 bits.
+__attribute__((target("ssse3")))
+void accumulate_ssse3(const BoardBatch& batch, int (&scores)[BatchWidth]) noexcept {
+    const auto nibble_mask = _mm_set1_epi8(0x0F);
+    __m128i sums32[4] = { _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128() };
+
+    for (int j0 = 0; j0 < 8 * 8 / 2; j0 += 8) {
+        auto sums16_lo = _mm_setzero_si128();
+        auto sums16_hi = _mm_setzero_si128();
 
-    state.foreach_piece([&](Coord c, Player p, Piece pc) {
-        const auto score_mul = (p == eval_player) ? 1 : -1;
-        auto add_points = [&](int points) { score += score_mul * points; };
+        for (int j = j0; j < j0 + 8; ++j) {
+            const auto packed = _mm_load_si128(reinterpret_cast<const __m128i*>(batch.packed[j]));
+            const __m128i nibbles[2] = {
+                _mm_and_si128(packed, nibble_mask),
+                _mm_and_si128(_mm_srli_epi16(packed, 4), nibble_mask)
+            };
 
-        switch (pc) {
-            case Pawn: {
-                const auto advancement = is_white(p) ? (c.rank - 2) : (7 - c.rank);
-                add_points(100 + 20 * advancement);
-                break;
+            for (int h = 0; h < 2; ++h) {
+                const int i = 2 * j + h;
+                const auto low_lut = _mm_load_si128(reinterpret_cast<const __m128i*>(piece_square_byte_tables.low[i]));
+                const auto high_lut = _mm_load_si128(reinterpret_cast<const __m128i*>(piece_square_byte_tables.high[i]));
+                const auto low = _mm_shuffle_epi8(low_lut, nibbles[h]);
+                const auto high = _mm_shuffle_epi8(high_lut, nibbles[h]);
+                sums16_lo = _mm_add_epi16(sums16_lo, _mm_unpacklo_epi8(low, high));
+                sums16_hi = _mm_add_epi16(sums16_hi, _mm_unpackhi_epi8(low, high));
             }
-            case Knight:
-                add_points(300);
-                break;
-            case Bishop:
-                add_points(320);
-                break;
-            case Rook:
-                add_points(500);
-                break;
-            case Queen:
-                add_points(800);
-                break;
-            default:
-                break;
+        }
+
+        sums32[0] = _mm_add_epi32(sums32[0], _mm_srai_epi32(_mm_unpacklo_epi16(sums16_lo, sums16_lo), 16));
+        sums32[1] = _mm_add_epi32(sums32[1], _mm_srai_epi32(_mm_unpackhi_epi16(sums16_lo, sums16_lo), 16));
+        sums32[2] = _mm_add_epi32(sums32[2], _mm_srai_epi32(_mm_unpacklo_epi16(sums16_hi, sums16_hi), 16));
+        sums32[3] = _mm_add_epi32(sums32[3], _mm_srai_epi32(_mm_unpackhi_epi16(sums16_hi, sums16_hi), 16));
+    }
+
+    for (int k = 0; k < 4; ++k) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&scores[4 * k]), sums32[k]);
+    }
+}
+
+#endif
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+constexpr int DoubledPawnPenalty = 12;
+constexpr int IsolatedPawnPenalty = 15;
+constexpr int BackwardPawnPenalty = 10;
+constexpr int PassedPawnBonus[8] = {0, 0, 10, 15, 25, 40, 65, 0};  // By the rank relative to the pawn's owner.
+
+// The ranks strictly in front of `rank`, as seen by player `p`.
+constexpr Bitboard ranks_in_front(Player p, int rank) noexcept {
+    if (is_white(p)) return rank < 8 ? ~Bitboard{0} << (8 * rank) : 0;
+    return (Bitboard{1} << (8 * (rank - 1))) - 1;
+}
+
+constexpr Bitboard adjacent_files(int file) noexcept {
+    return shift_east(file_bitboard(file)) | shift_west(file_bitboard(file));
+}
+
+int pawn_structure_of(Player p, Bitboard own_pawns, Bitboard their_pawns) noexcept {
+    int score = 0;
+    const auto their_pawn_attacks = pawn_attacks(other_player(p), their_pawns);
+
+    foreach_bit(own_pawns, [&](int i) {
+        const auto c = coord_of(i);
+        const auto file = file_bitboard(c.file);
+        const auto adjacent = adjacent_files(c.file);
+        const auto in_front = ranks_in_front(p, c.rank);
+
+        if (own_pawns & file & in_front) {
+            score -= DoubledPawnPenalty;
+        }
+
+        if (!(own_pawns & adjacent)) {
+            score -= IsolatedPawnPenalty;
+        }
+        else if (!(own_pawns & adjacent & ~in_front) && (their_pawn_attacks & shift_forward(p, bit(i)))) {
+            // No neighbour can ever defend the pawn, and its stop square is controlled by an enemy pawn.
+            score -= BackwardPawnPenalty;
+        }
+
+        if (!(their_pawns & (file | adjacent) & in_front)) {
+            const int relative_rank = is_white(p) ? c.rank : 9 - c.rank;
+            score += PassedPawnBonus[relative_rank - 1];
         }
     });
 
     return score;
 }
 
+struct PawnHashEntry {
+    uint64_t key;
+    int score;  // From the white player's perspective.
+};
+
+// Direct-mapped. A zeroed entry is valid: a zero key stands for no pawns at all, which scores zero.
+struct PawnHashTable {
+    std::array<PawnHashEntry, 1 << 13> entries{};
+    HashTableStats stats;
+};
+
+thread_local PawnHashTable pawn_hash_table;
+
+int pawn_structure(Bitboard white_pawns, Bitboard black_pawns) noexcept {
+    const auto key = zobrist_pawn_key(white_pawns, black_pawns);
+    auto& table = pawn_hash_table;
+    auto& entry = table.entries[key & (table.entries.size() - 1)];
+
+    ++table.stats.probes;
+    if (entry.key == key) {
+        ++table.stats.hits;
+        return entry.score;
+    }
+
+    entry.key = key;
+    entry.score =
+        pawn_structure_of(Player::White, white_pawns, black_pawns) -
+        pawn_structure_of(Player::Black, black_pawns, white_pawns);
+    return entry.score;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Lockless hashing: https://www.chessprogramming.org/Shared_Hash_Table#Lockless
+// Each entry stores the data and the key XOR-ed with the data. A reader accepts the entry only if both words come
+// from the same write, and a zeroed entry lacks the `valid_bit`, so it never matches.
+class EvalCache {
+    struct Entry {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    static constexpr uint64_t valid_bit = uint64_t{1} << 32;
+
+    std::unique_ptr<Entry[]> _entries;
+    uint64_t _mask = 0;
+    int _size_log2 = 0;
+
+public:
+    explicit EvalCache(int size_log2) { resize(size_log2); }
+
+    void resize(int size_log2) {
+        assert(size_log2 >= 0 && size_log2 < 40);
+        _entries = size_log2 > 0 ? std::make_unique<Entry[]>(size_t{1} << size_log2) : nullptr;
+        _mask = size_log2 > 0 ? (uint64_t{1} << size_log2) - 1 : 0;
+        _size_log2 = size_log2;
+    }
+
+    int size_log2() const noexcept { return _size_log2; }
+    bool enabled() const noexcept { return _entries != nullptr; }
+
+    bool probe(uint64_t key, int& score) const noexcept {
+        const auto& entry = _entries[key & _mask];
+        const auto data = entry.data.load(std::memory_order_relaxed);
+        const auto check = entry.check.load(std::memory_order_relaxed);
+        if ((check ^ data) != key || !(data & valid_bit)) return false;
+        score = static_cast<int32_t>(static_cast<uint32_t>(data));
+        return true;
+    }
+
+    void store(uint64_t key, int score) noexcept {
+        auto& entry = _entries[key & _mask];
+        const auto data = valid_bit | static_cast<uint32_t>(score);
+        entry.check.store(key ^ data, std::memory_order_relaxed);
+        entry.data.store(data, std::memory_order_relaxed);
+    }
+};
+
+EvalCache eval_cache{DefaultEvalCacheSizeLog2};
+thread_local HashTableStats eval_cache_thread_stats;
+
+// `evaluate_hardcode` is not symmetric in the evaluating player, so it is part of the key.
+constexpr uint64_t BlackEvalPlayerKey = 0x9C2F0A5E3B7D4161ull;
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+constexpr int MobilityWeight = 4;        // Per square reachable by a knight, bishop, rook or queen.
+constexpr int KingZoneAttackWeight = 6;  // Per attack on the opponent's king or a square next to it.
+
+struct Activity {
+    Bitboard attacks;  // All the squares attacked by the player.
+    int score;         // Mobility and king-zone attacks.
+};
+
+Activity activity_of(Player p, const Bitboards& bbs) noexcept {
+    const auto opponent = other_player(p);
+    const auto occupied = bbs.occupied();
+    const auto not_own = ~bbs.of(p);
+
+    const auto their_king = bbs.of(opponent, Piece::King);
+    const auto king_zone = their_king ? (their_king | king_attacks(coord_of(lsb_index(their_king)))) : Bitboard{0};
+
+    auto activity = Activity{pawn_attacks(p, bbs.of(p, Piece::Pawn)), 0};
+    int mobility = 0;
+    int king_zone_attacks = popcount(activity.attacks & king_zone);
+
+    auto add_attacks = [&](Bitboard attacks) {
+        activity.attacks |= attacks;
+        mobility += popcount(attacks & not_own);
+        king_zone_attacks += popcount(attacks & king_zone);
+    };
+
+    foreach_bit(bbs.of(p, Piece::Knight), [&](int i) { add_attacks(knight_attacks(coord_of(i))); });
+    foreach_bit(bbs.of(p, Piece::Bishop), [&](int i) { add_attacks(bishop_attacks(coord_of(i), occupied)); });
+    foreach_bit(bbs.of(p, Piece::Rook), [&](int i) { add_attacks(rook_attacks(coord_of(i), occupied)); });
+    foreach_bit(bbs.of(p, Piece::Queen), [&](int i) { add_attacks(queen_attacks(coord_of(i), occupied)); });
+    foreach_bit(bbs.of(p, Piece::King), [&](int i) { activity.attacks |= king_attacks(coord_of(i)); });
+
+    activity.score = MobilityWeight * mobility + KingZoneAttackWeight * king_zone_attacks;
+    return activity;
+}
+
+} // namespace
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+int evaluate_hardcode(Player eval_player, const GameNode& node) noexcept
+{
+    const auto& state = node.state;
+    const auto player_to_move = state.player_to_move;
+    const auto score_mul = (player_to_move == eval_player) ? 1 : -1;
+
+    const auto bbs = make_bitboards(state);
+    const auto white = activity_of(Player::White, bbs);
+    const auto black = activity_of(Player::Black, bbs);
+    const auto& opponent = is_white(player_to_move) ? black : white;
+    const bool king_in_check = opponent.attacks & bbs.of(player_to_move, Piece::King);
+
+    if (!node.has_any_legal_move()) {
+        if (king_in_check) {
+            // Checkmate
+            return -MateValue * score_mul;
+        }
+        else {
+            // Stalemate
+            return 0;  // A draw.
+        }
+    }
+
+    int score = 60 * score_mul;
+
+    if (king_in_check) {
+        score += -80 * score_mul;
+    }
+
+    const auto activity = white.score - black.score;
+    score += is_white(eval_player) ? activity : -activity;
+
+    score += evaluate_material(eval_player, state);
+
+    const auto pawns = pawn_structure(bbs.of(Player::White, Piece::Pawn), bbs.of(Player::Black, Piece::Pawn));
+    score += is_white(eval_player) ? pawns : -pawns;
+
+    return score;
+}
+
+int evaluate_basic(Player eval_player, const GameNode& node) noexcept
+{
+    if (!node.has_any_legal_move()) {
+        const auto score_mul = (node.state.player_to_move == eval_player) ? 1 : -1;
+        return node.king_in_check() ? -MateValue * score_mul : 0;
+    }
+    return evaluate_material(eval_player, node.state);
+}
+
+int evaluate_material(Player eval_player, const GameState& state) noexcept
+{
+    int score = 0;
+    for (int j = 0; j < static_cast<int>(state.squares.size()); ++j) {
+        const auto tsq = state.squares[j];
+        if (tsq == 0) continue;
+        score += piece_square_table[tsq & 0x0F][2 * j] + piece_square_table[tsq >> 4][2 * j + 1];
+    }
+    return is_white(eval_player) ? score : -score;
+}
+
+int evaluate_pawn_structure(Player eval_player, const GameState& state) noexcept
+{
+    const auto bbs = make_bitboards(state);
+    const auto score = pawn_structure(bbs.of(Player::White, Piece::Pawn), bbs.of(Player::Black, Piece::Pawn));
+    return is_white(eval_player) ? score : -score;
+}
+
+HashTableStats pawn_hash_stats() noexcept
+{
+    return pawn_hash_table.stats;
+}
+
+void configure_eval_cache(int size_log2)
+{
+    eval_cache.resize(size_log2);
+}
+
+int eval_cache_size_log2() noexcept
+{
+    return eval_cache.size_log2();
+}
+
+int evaluate_cached(Player eval_player, const GameNode& node) noexcept
+{
+    if (!eval_cache.enabled()) {
+        return evaluate_hardcode(eval_player, node);
+    }
+
+    const auto key = zobrist_key(node.state) ^ (is_black(eval_player) ? BlackEvalPlayerKey : 0);
+    auto& stats = eval_cache_thread_stats;
+    ++stats.probes;
+
+    int score;
+    if (eval_cache.probe(key, score)) {
+        ++stats.hits;
+        return score;
+    }
+
+    score = evaluate_hardcode(eval_player, node);
+    eval_cache.store(key, score);
+    return score;
+}
+
+HashTableStats eval_cache_stats() noexcept
+{
+    return eval_cache_thread_stats;
+}
+
+void evaluate_batch(Player eval_player, const GameState* states, int* scores, size_t count) noexcept
+{
+#if defined(ROOKMOLE_EVALUATE_BATCH_SSSE3)
+    static const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+#endif
+
+    const int score_mul = is_white(eval_player) ? 1 : -1;
+    auto batch = BoardBatch{};
+    int batch_scores[BatchWidth];
+
+    for (size_t offset = 0; offset < count; offset += BatchWidth) {
+        const auto batch_count = std::min(BatchWidth, count - offset);
+        transpose(states + offset, batch_count, batch);
+
+#if defined(ROOKMOLE_EVALUATE_BATCH_SSSE3)
+        if (has_ssse3)
+            accumulate_ssse3(batch, batch_scores);
+        else
+#endif
+            accumulate_generic(batch, batch_scores);
+
+        for (size_t lane = 0; lane < batch_count; ++lane) {
+            scores[offset + lane] = score_mul * batch_scores[lane];
+        }
+    }
+}
+
 //=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
 
 } // namespace rookmole
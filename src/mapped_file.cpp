@@ -0,0 +1,127 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#include "rookmole/mapped_file.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) noexcept
+{
+    const auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return;
+    _file_handle = file;
+
+    auto size = LARGE_INTEGER{};
+    if (!GetFileSizeEx(file, &size)) { close(); return; }
+    _size = static_cast<size_t>(size.QuadPart);
+
+    if (_size > 0) {
+        _mapping_handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (_mapping_handle == nullptr) { close(); return; }
+        _data = static_cast<const char*>(MapViewOfFile(_mapping_handle, FILE_MAP_READ, 0, 0, 0));
+        if (_data == nullptr) { close(); return; }
+    }
+    _open = true;
+}
+
+void MappedFile::close() noexcept
+{
+    if (_data != nullptr) UnmapViewOfFile(_data);
+    if (_mapping_handle != nullptr) CloseHandle(_mapping_handle);
+    if (_file_handle != nullptr) CloseHandle(_file_handle);
+    _data = nullptr;
+    _size = 0;
+    _open = false;
+    _mapping_handle = nullptr;
+    _file_handle = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) noexcept
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) { ::close(fd); return; }
+    _size = static_cast<size_t>(st.st_size);
+
+    if (_size > 0) {
+        void* addr = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) { ::close(fd); _size = 0; return; }
+        ::madvise(addr, _size, MADV_SEQUENTIAL);
+        _data = static_cast<const char*>(addr);
+    }
+
+    // The mapping stays valid after the descriptor is closed.
+    ::close(fd);
+    _open = true;
+}
+
+void MappedFile::close() noexcept
+{
+    if (_data != nullptr) ::munmap(const_cast<char*>(_data), _size);
+    _data = nullptr;
+    _size = 0;
+    _open = false;
+}
+
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+        std::swap(_open, other._open);
+#ifdef _WIN32
+        std::swap(_file_handle, other._file_handle);
+        std::swap(_mapping_handle, other._mapping_handle);
+#endif
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
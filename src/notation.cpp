@@ -0,0 +1,468 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+#include "rookmole/notation.h"
+#include "rookmole/bitboard.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+namespace {
+
+bool is_promotion(const GameState& s, MoveCoord m) noexcept {
+    const auto sq_from = s(m.from);
+    return piece_of(sq_from) == Piece::Pawn && (m.to.rank == 1 || m.to.rank == 8);
+}
+
+Piece piece_of_san_letter(char c) noexcept {
+    switch (c) {
+        case 'N': return Piece::Knight;
+        case 'B': return Piece::Bishop;
+        case 'R': return Piece::Rook;
+        case 'Q': return Piece::Queen;
+        case 'K': return Piece::King;
+        default:  return Piece::None;
+    }
+}
+
+char san_letter_of(Piece pc) noexcept {
+    switch (pc) {
+        case Piece::Knight: return 'N';
+        case Piece::Bishop: return 'B';
+        case Piece::Rook:   return 'R';
+        case Piece::Queen:  return 'Q';
+        case Piece::King:   return 'K';
+        default:            return '?';
+    }
+}
+
+bool is_en_passant_capture(const GameState& s, MoveCoord m) noexcept {
+    return s.en_passant_file != 0 && piece_of(s(m.from)) == Piece::Pawn &&
+        m.to == Coord{s.en_passant_file, is_white(s.player_to_move) ? 6 : 3};
+}
+
+// Whether a pseudo-legal move leaves the king of the player to move unattacked.
+bool is_king_safe_after(const GameState& s, MoveCoord m) noexcept {
+    auto t = s;
+    const auto sq_from = t(m.from);
+    if (is_en_passant_capture(s, m)) {
+        t.set_square(Coord{m.to.file, m.from.rank}, Square::Empty);
+    }
+    t.set_square(m.from, Square::Empty);
+    t.set_square(m.to, sq_from);
+
+    const auto king_coord = piece_of(sq_from) == Piece::King ? m.to : find_king(s.player_to_move, t);
+    return is_invalid(king_coord) || !is_attacked_by(other_player(s.player_to_move), king_coord, t);
+}
+
+constexpr char FenPieceLetters[] = " PNBRQK  pnbrqk ";
+
+constexpr std::array<Square, 128> make_fen_piece_table() noexcept {
+    auto table = std::array<Square, 128>{};
+    for (int sq = 0; sq < 16; ++sq) {
+        if (FenPieceLetters[sq] != ' ') table[static_cast<uint8_t>(FenPieceLetters[sq])] = static_cast<Square>(sq);
+    }
+    return table;
+}
+
+constexpr auto FenPieceTable = make_fen_piece_table();
+
+// Splits off the next space-separated field.
+std::string_view next_field(std::string_view& text) noexcept {
+    while (!text.empty() && text.front() == ' ') text.remove_prefix(1);
+    const auto end = std::min(text.find(' '), text.size());
+    const auto field = text.substr(0, end);
+    text.remove_prefix(end);
+    return field;
+}
+
+std::optional<int> parse_counter(std::string_view field) noexcept {
+    if (field.empty() || field.size() > 6) return std::nullopt;
+    int value = 0;
+    for (const char c : field) {
+        if (c < '0' || c > '9') return std::nullopt;
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+std::optional<MoveCoord> legal_or_nullopt(const GameState& s, MoveCoord m) {
+    if (!is_move_coord_legal(get_legal_moves(s), m)) return std::nullopt;
+    return m;
+}
+
+} // namespace
+
+std::string to_uci_move(const GameState& s, MoveCoord m)
+{
+    auto text = to_string(m.from) + to_string(m.to);
+    if (is_promotion(s, m)) text.push_back('q');
+    return text;
+}
+
+std::optional<MoveCoord> parse_uci_move(const GameState& s, std::string_view text)
+{
+    if (text.size() != 4 && text.size() != 5) return std::nullopt;
+    for (size_t i : {0, 2}) {
+        if (text[i] < 'a' || text[i] > 'h' || text[i + 1] < '1' || text[i + 1] > '8') return std::nullopt;
+    }
+
+    const auto m = MoveCoord{Coord{text.substr(0, 2)}, Coord{text.substr(2, 2)}};
+    if (!is_move_coord_legal(get_legal_moves(s), m)) return std::nullopt;
+    if (is_promotion(s, m) ? (text.size() == 5 && text[4] != 'q') : text.size() == 5) return std::nullopt;
+
+    return m;
+}
+
+std::string to_uci_line(GameState s, const MoveCoordVec& moves)
+{
+    auto text = std::string{};
+    for (const auto m : moves) {
+        if (!text.empty()) text.push_back(' ');
+        text.append(to_uci_move(s, m));
+        s = make_move(s, m).state;
+    }
+    return text;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+std::string to_san_move(const GameState& s, MoveCoord m)
+{
+    const auto pc = piece_of(s(m.from));
+    auto text = std::string{};
+
+    if (pc == Piece::King && std::abs(m.from.file - m.to.file) == 2) {
+        text = m.to.file > m.from.file ? "O-O" : "O-O-O";
+    }
+    else {
+        const bool capture = !is_empty(s(m.to)) || is_en_passant_capture(s, m);
+
+        if (pc == Piece::Pawn) {
+            if (capture) text.push_back(static_cast<char>('a' + m.from.file - 1));
+        }
+        else {
+            text.push_back(san_letter_of(pc));
+
+            // Disambiguate from other pieces of the same kind which can move to the same square.
+            bool ambiguous = false, same_file = false, same_rank = false;
+            for (const auto other : get_legal_moves(s)) {
+                if (other.to != m.to || other.from == m.from || piece_of(s(other.from)) != pc) continue;
+                ambiguous = true;
+                same_file |= other.from.file == m.from.file;
+                same_rank |= other.from.rank == m.from.rank;
+            }
+            if (ambiguous) {
+                if (!same_file) text.push_back(static_cast<char>('a' + m.from.file - 1));
+                else if (!same_rank) text.push_back(static_cast<char>('0' + m.from.rank));
+                else text.append(to_string(m.from));
+            }
+        }
+
+        if (capture) text.push_back('x');
+        text.append(to_string(m.to));
+        if (is_promotion(s, m)) text.append("=Q");
+    }
+
+    const auto n = make_move(s, m);
+    if (n.king_in_check()) {
+        text.push_back(n.has_any_legal_move() ? '+' : '#');
+    }
+
+    return text;
+}
+
+std::optional<MoveCoord> parse_san_move(const GameState& s, std::string_view text)
+{
+    while (!text.empty() && (text.back() == '+' || text.back() == '#' || text.back() == '!' || text.back() == '?')) {
+        text.remove_suffix(1);
+    }
+
+    const auto me = s.player_to_move;
+    const int8_t home_rank = is_white(me) ? 1 : 8;
+
+    if (text == "O-O" || text == "0-0") return legal_or_nullopt(s, {Coord{5, home_rank}, Coord{7, home_rank}});
+    if (text == "O-O-O" || text == "0-0-0") return legal_or_nullopt(s, {Coord{5, home_rank}, Coord{3, home_rank}});
+
+    // Promotion suffix: "=Q" or "Q". Under-promotions are not supported.
+    if (text.size() > 2 && piece_of_san_letter(text.back()) != Piece::None) {
+        if (text.back() != 'Q') return std::nullopt;
+        text.remove_suffix(1);
+        if (text.back() == '=') text.remove_suffix(1);
+    }
+
+    if (text.size() < 2) return std::nullopt;
+    const char to_file = text[text.size() - 2];
+    const char to_rank = text[text.size() - 1];
+    if (to_file < 'a' || to_file > 'h' || to_rank < '1' || to_rank > '8') return std::nullopt;
+    const auto to = Coord{to_file - 'a' + 1, to_rank - '0'};
+    text.remove_suffix(2);
+
+    auto pc = Piece::Pawn;
+    if (!text.empty() && piece_of_san_letter(text.front()) != Piece::None) {
+        pc = piece_of_san_letter(text.front());
+        text.remove_prefix(1);
+    }
+
+    bool capture = false;
+    if (!text.empty() && text.back() == 'x') {
+        capture = true;
+        text.remove_suffix(1);
+    }
+
+    int from_file = 0;
+    int from_rank = 0;
+    for (const char c : text) {
+        if (c >= 'a' && c <= 'h' && from_file == 0) from_file = c - 'a' + 1;
+        else if (c >= '1' && c <= '8' && from_rank == 0) from_rank = c - '0';
+        else return std::nullopt;
+    }
+
+    const auto bbs = make_bitboards(s);
+    const auto occupied = bbs.occupied();
+    if (bbs.of(me) & bit(to)) return std::nullopt;
+
+    Bitboard candidates = 0;
+    switch (pc) {
+        case Piece::Knight: candidates = knight_attacks(to) & bbs.of(me, Piece::Knight); break;
+        case Piece::Bishop: candidates = bishop_attacks(to, occupied) & bbs.of(me, Piece::Bishop); break;
+        case Piece::Rook:   candidates = rook_attacks(to, occupied) & bbs.of(me, Piece::Rook); break;
+        case Piece::Queen:  candidates = queen_attacks(to, occupied) & bbs.of(me, Piece::Queen); break;
+        case Piece::King:   candidates = king_attacks(to) & bbs.of(me, Piece::King); break;
+        case Piece::Pawn: {
+            const int fwd = is_white(me) ? 1 : -1;
+            const auto behind = Coord{to.file, to.rank - fwd};
+            if (is_invalid(behind)) return std::nullopt;
+
+            if (from_file != 0 && from_file != to.file) {
+                const auto from = Coord{from_file, to.rank - fwd};
+                if (std::abs(from_file - to.file) != 1) return std::nullopt;
+                if (is_empty(s(to)) && !is_en_passant_capture(s, {from, to})) return std::nullopt;
+                candidates = bbs.of(me, Piece::Pawn) & bit(from);
+            }
+            else if (is_empty(s(to)) && !capture) {
+                if (s(behind) == make_square(me, Piece::Pawn)) {
+                    candidates = bit(behind);
+                }
+                else if (is_empty(s(behind)) && to.rank == (is_white(me) ? 4 : 5)) {
+                    candidates = bbs.of(me, Piece::Pawn) & bit(Coord{to.file, to.rank - 2 * fwd});
+                }
+            }
+            break;
+        }
+        default:
+            return std::nullopt;
+    }
+
+    if (from_file != 0) candidates &= file_bitboard(from_file);
+    if (from_rank != 0) candidates &= rank_bitboard(from_rank);
+
+    auto found = std::optional<MoveCoord>{};
+    int found_count = 0;
+    foreach_bit(candidates, [&](int i) {
+        const auto m = MoveCoord{coord_of(i), to};
+        if (is_king_safe_after(s, m)) {
+            found = m;
+            ++found_count;
+        }
+    });
+
+    if (found_count != 1) return std::nullopt;
+    return found;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+std::optional<GameState> parse_fen(std::string_view text) noexcept
+{
+    auto s = GameState{};
+
+    // Piece placement, from the 8th rank down.
+    const auto placement = next_field(text);
+    int rank = 8;
+    int file = 1;
+    for (const char c : placement) {
+        if (c == '/') {
+            if (file != 9 || rank == 1) return std::nullopt;
+            --rank;
+            file = 1;
+        }
+        else if (c >= '1' && c <= '8') {
+            file += c - '0';
+            if (file > 9) return std::nullopt;
+        }
+        else {
+            const auto sq = static_cast<uint8_t>(c) < FenPieceTable.size() ? FenPieceTable[static_cast<uint8_t>(c)] : Square::Empty;
+            if (sq == Square::Empty || file > 8) return std::nullopt;
+            s.set_square(Coord{file, rank}, sq);
+            ++file;
+        }
+    }
+    if (rank != 1 || file != 9) return std::nullopt;
+
+    // Only the positions the move generator can handle: a king of each side, and no pawns on the back ranks.
+    int king_counts[2] = {};
+    for (int i = 0; i < 64; ++i) {
+        const auto sq = s.square_at(i);
+        if (is_empty(sq)) continue;
+        if (piece_of(sq) == Piece::King) ++king_counts[player_of(sq)];
+        if (piece_of(sq) == Piece::Pawn && (i < 8 || i >= 56)) return std::nullopt;
+    }
+    if (king_counts[Player::White] != 1 || king_counts[Player::Black] != 1) return std::nullopt;
+
+    const auto side = next_field(text);
+    if (side == "w") s.player_to_move = Player::White;
+    else if (side == "b") s.player_to_move = Player::Black;
+    else return std::nullopt;
+
+    const auto castling = next_field(text);
+    if (castling.empty()) return std::nullopt;
+    s.a1_castling_forbidden = s.h1_castling_forbidden = s.a8_castling_forbidden = s.h8_castling_forbidden = true;
+    if (castling != "-") {
+        for (const char c : castling) {
+            switch (c) {
+                case 'K': s.h1_castling_forbidden = false; break;
+                case 'Q': s.a1_castling_forbidden = false; break;
+                case 'k': s.h8_castling_forbidden = false; break;
+                case 'q': s.a8_castling_forbidden = false; break;
+                default: return std::nullopt;
+            }
+        }
+    }
+
+    const auto en_passant = next_field(text);
+    if (en_passant.empty()) return std::nullopt;
+    if (en_passant != "-") {
+        if (en_passant.size() != 2 || en_passant[0] < 'a' || en_passant[0] > 'h' ||
+            en_passant[1] != (is_white(s.player_to_move) ? '6' : '3')) return std::nullopt;
+        s.en_passant_file = en_passant[0] - 'a' + 1;
+    }
+
+    // Optional counters.
+    const auto halfmove = next_field(text);
+    if (!halfmove.empty()) {
+        if (!parse_counter(halfmove)) return std::nullopt;
+        const auto fullmove = parse_counter(next_field(text));
+        if (!fullmove) return std::nullopt;
+        s.move_count = std::clamp(*fullmove - 1, 0, 127);
+    }
+
+    if (!next_field(text).empty()) return std::nullopt;
+
+    // The king of the player who has just moved cannot be in check.
+    auto opponent_to_move = s;
+    opponent_to_move.player_to_move = other_player(s.player_to_move);
+    if (is_king_in_check(opponent_to_move)) return std::nullopt;
+    return s;
+}
+
+std::string_view to_fen(const GameState& s, FenBuffer& buffer) noexcept
+{
+    char* out = buffer.data();
+
+    for (int rank = 8; rank >= 1; --rank) {
+        int empty_run = 0;
+        for (int file = 1; file <= 8; ++file) {
+            const auto sq = s(Coord{file, rank});
+            if (is_empty(sq)) {
+                ++empty_run;
+                continue;
+            }
+            if (empty_run > 0) *out++ = static_cast<char>('0' + empty_run);
+            empty_run = 0;
+            *out++ = FenPieceLetters[sq];
+        }
+        if (empty_run > 0) *out++ = static_cast<char>('0' + empty_run);
+        if (rank > 1) *out++ = '/';
+    }
+
+    *out++ = ' ';
+    *out++ = is_white(s.player_to_move) ? 'w' : 'b';
+    *out++ = ' ';
+
+    const char* castling_begin = out;
+    if (!s.h1_castling_forbidden) *out++ = 'K';
+    if (!s.a1_castling_forbidden) *out++ = 'Q';
+    if (!s.h8_castling_forbidden) *out++ = 'k';
+    if (!s.a8_castling_forbidden) *out++ = 'q';
+    if (out == castling_begin) *out++ = '-';
+    *out++ = ' ';
+
+    if (s.en_passant_file != 0) {
+        *out++ = static_cast<char>('a' + s.en_passant_file - 1);
+        *out++ = is_white(s.player_to_move) ? '6' : '3';
+    }
+    else {
+        *out++ = '-';
+    }
+
+    *out++ = ' ';
+    *out++ = '0';
+    *out++ = ' ';
+
+    const int fullmove = s.move_count + 1;
+    if (fullmove >= 100) *out++ = static_cast<char>('0' + fullmove / 100);
+    if (fullmove >= 10) *out++ = static_cast<char>('0' + fullmove / 10 % 10);
+    *out++ = static_cast<char>('0' + fullmove % 10);
+
+    return std::string_view{buffer.data(), static_cast<size_t>(out - buffer.data())};
+}
+
+std::optional<EpdRecord> parse_epd(std::string_view line)
+{
+    // The position: the first four fields.
+    auto rest = line;
+    for (int i = 0; i < 4; ++i) {
+        if (next_field(rest).empty()) return std::nullopt;
+    }
+    const auto state = parse_fen(line.substr(0, line.size() - rest.size()));
+    if (!state) return std::nullopt;
+
+    auto record = EpdRecord{*state, MoveCoordVec{}, MoveCoordVec{}, std::string{}};
+
+    // Operations: an opcode and space-separated operands, terminated by a semicolon (outside of quotes).
+    while (!rest.empty()) {
+        size_t end = 0;
+        bool quoted = false;
+        while (end < rest.size() && (quoted || rest[end] != ';')) {
+            if (rest[end] == '"') quoted = !quoted;
+            ++end;
+        }
+        auto operation = rest.substr(0, end);
+        rest.remove_prefix(std::min(end + 1, rest.size()));
+
+        const auto opcode = next_field(operation);
+        if (opcode == "bm" || opcode == "am") {
+            auto& moves = opcode == "bm" ? record.best_moves : record.avoid_moves;
+            for (auto san = next_field(operation); !san.empty(); san = next_field(operation)) {
+                const auto m = parse_san_move(record.state, san);
+                if (!m) return std::nullopt;
+                moves.push_back(*m);
+            }
+        }
+        else if (opcode == "id") {
+            while (!operation.empty() && (operation.front() == ' ' || operation.front() == '"')) operation.remove_prefix(1);
+            while (!operation.empty() && (operation.back() == ' ' || operation.back() == '"' || operation.back() == '\r')) operation.remove_suffix(1);
+            record.id = std::string{operation};
+        }
+    }
+
+    return record;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
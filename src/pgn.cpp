@@ -0,0 +1,259 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#include "rookmole/pgn.h"
+#include "rookmole/mapped_file.h"
+#include "rookmole/notation.h"
+#include "rookmole/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+namespace {
+
+constexpr bool is_space(char c) noexcept { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v'; }
+constexpr bool is_token_end(char c) noexcept { return is_space(c) || c == '{' || c == '}' || c == '(' || c == ')' || c == '[' || c == ';'; }
+
+std::optional<GameResult> parse_result_token(std::string_view token) noexcept {
+    if (token == "1-0") return GameResult::WhiteWon;
+    if (token == "0-1") return GameResult::BlackWon;
+    if (token == "1/2-1/2") return GameResult::Draw;
+    if (token == "*") return GameResult::Unknown;
+    return std::nullopt;
+}
+
+// Strips a leading move number, as in "12.", "12..." or "12.Nf3".
+std::string_view strip_move_number(std::string_view token) noexcept {
+    size_t i = 0;
+    while (i < token.size() && token[i] >= '0' && token[i] <= '9') ++i;
+    if (i < token.size() && token[i] != '.') return token;
+    while (i < token.size() && token[i] == '.') ++i;
+    return token.substr(i);
+}
+
+// Replays consecutive games of a PGN text. The buffers of the game are reused from one game to the next.
+class PgnReplayer {
+    const PgnGameCallback& _on_game;
+    PgnReplayStats _stats;
+    PgnGame _game;
+    GameState _state;
+    bool _in_game = false;
+    bool _in_movetext = false;
+    bool _failed = false;
+
+    void begin_game() {
+        _game.states.clear();
+        _game.moves.clear();
+        _game.result = GameResult::Unknown;
+        _state = make_start_state();
+        _game.states.push_back(_state);
+        _in_game = true;
+        _in_movetext = false;
+        _failed = false;
+    }
+
+    void end_game() {
+        if (!_in_game) return;
+        if (_failed) {
+            ++_stats.skipped_games;
+        }
+        else {
+            ++_stats.games;
+            _stats.positions += _game.states.size();
+            _on_game(_game);
+        }
+        _in_game = false;
+    }
+
+    void on_tag(std::string_view name, std::string_view value) {
+        if (name != "FEN") return;
+        const auto initial_state = parse_fen(value);
+        if (!initial_state) {
+            _failed = true;
+            return;
+        }
+        _state = *initial_state;
+        _game.states.assign(1, _state);
+    }
+
+    void on_move(std::string_view san) {
+        if (_failed) return;
+        const auto m = parse_san_move(_state, san);
+        if (!m) {
+            _failed = true;
+            return;
+        }
+        _state = make_move(_state, *m).state;
+        _game.moves.push_back(*m);
+        _game.states.push_back(_state);
+    }
+
+public:
+    explicit PgnReplayer(const PgnGameCallback& on_game) : _on_game{on_game} {}
+
+    const PgnReplayStats& stats() const noexcept { return _stats; }
+
+    void replay(std::string_view text) {
+        const size_t n = text.size();
+        size_t pos = 0;
+
+        const auto skip_to = [&](char c) {
+            while (pos < n && text[pos] != c) ++pos;
+            if (pos < n) ++pos;
+        };
+
+        while (pos < n) {
+            const char c = text[pos];
+
+            if (is_space(c)) {
+                ++pos;
+            }
+            else if (c == '[') {
+                if (_in_movetext) end_game();
+                if (!_in_game) begin_game();
+
+                ++pos;
+                const size_t name_begin = pos;
+                while (pos < n && !is_space(text[pos]) && text[pos] != ']' && text[pos] != '"') ++pos;
+                const auto name = text.substr(name_begin, pos - name_begin);
+                skip_to('"');
+                const size_t value_begin = pos;
+                while (pos < n && text[pos] != '"') {
+                    pos += (text[pos] == '\\' && pos + 1 < n) ? 2 : 1;
+                }
+                const auto value = text.substr(value_begin, std::min(pos, n) - value_begin);
+                skip_to(']');
+                on_tag(name, value);
+            }
+            else if (c == '{') {
+                skip_to('}');
+            }
+            else if (c == ';' || (c == '%' && (pos == 0 || text[pos - 1] == '\n'))) {
+                skip_to('\n');
+            }
+            else if (c == '(') {
+                // Variations may nest and contain comments with parentheses.
+                int depth = 0;
+                while (pos < n) {
+                    const char v = text[pos++];
+                    if (v == '(') ++depth;
+                    else if (v == ')' && --depth == 0) break;
+                    else if (v == '{') skip_to('}');
+                    else if (v == ';') skip_to('\n');
+                }
+            }
+            else if (c == ')' || c == '}' || c == ']') {
+                ++pos;
+            }
+            else {
+                const size_t token_begin = pos;
+                while (pos < n && !is_token_end(text[pos])) ++pos;
+                const auto token = text.substr(token_begin, pos - token_begin);
+
+                if (!_in_game) begin_game();
+                _in_movetext = true;
+
+                if (token[0] == '$') continue;
+                if (const auto result = parse_result_token(token)) {
+                    _game.result = *result;
+                    end_game();
+                    continue;
+                }
+                const auto san = strip_move_number(token);
+                if (!san.empty()) on_move(san);
+            }
+        }
+
+        end_game();
+    }
+};
+
+// Finds the first game which begins after `pos`: a tag line not preceded by another tag line.
+size_t find_game_start(std::string_view text, size_t pos) noexcept {
+    for (;;) {
+        pos = text.find("\n[", pos);
+        if (pos == std::string_view::npos) return text.size();
+
+        size_t prev_line = pos;
+        while (prev_line > 0 && text[prev_line - 1] != '\n') --prev_line;
+        if (text[prev_line] != '[') return pos + 1;
+
+        ++pos;
+    }
+}
+
+} // namespace
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+PgnReplayStats replay_pgn(std::string_view text, int thread_count, const PgnGameCallback& on_game)
+{
+    if (thread_count <= 0) {
+        thread_count = hardware_thread_count();
+    }
+
+    // Several chunks per thread, so that the workers even out the differences in game lengths.
+    constexpr size_t MinChunkSize = 1 << 16;
+    const size_t chunk_count = std::clamp<size_t>(text.size() / MinChunkSize, 1, static_cast<size_t>(thread_count) * 8);
+
+    auto boundaries = std::vector<size_t>{0};
+    for (size_t i = 1; i < chunk_count; ++i) {
+        const size_t b = find_game_start(text, std::max(boundaries.back() + 1, text.size() * i / chunk_count));
+        if (b >= text.size()) break;
+        boundaries.push_back(b);
+    }
+    boundaries.push_back(text.size());
+
+    auto next_chunk = std::atomic<size_t>{0};
+    auto stats = PgnReplayStats{};
+    auto stats_mutex = std::mutex{};
+
+    const auto work = [&] {
+        auto replayer = PgnReplayer{on_game};
+        for (size_t i = next_chunk++; i + 1 < boundaries.size(); i = next_chunk++) {
+            replayer.replay(text.substr(boundaries[i], boundaries[i + 1] - boundaries[i]));
+        }
+        const auto lock = std::lock_guard{stats_mutex};
+        stats += replayer.stats();
+    };
+
+    const int worker_count = std::min(thread_count, static_cast<int>(boundaries.size() - 1));
+    if (worker_count <= 1) {
+        work();
+    }
+    else {
+        auto workers = std::vector<std::thread>{};
+        workers.reserve(worker_count);
+        for (int i = 0; i < worker_count; ++i) workers.emplace_back(work);
+        for (auto& w : workers) w.join();
+    }
+
+    return stats;
+}
+
+std::optional<PgnReplayStats> replay_pgn_file(const std::string& path, int thread_count, const PgnGameCallback& on_game)
+{
+    const auto file = MappedFile{path};
+    if (!file.is_open()) return std::nullopt;
+    return replay_pgn(file.view(), thread_count, on_game);
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
@@ -0,0 +1,223 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+#include "rookmole/search.h"
+#include "rookmole/book.h"
+#include "rookmole/thread_pool.h"
+#include "rookmole/trace.h"
+#include <memory>
+#include <mutex>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+namespace {
+
+using SearchContextPtr = std::unique_ptr<SearchContext>;
+
+// One iteration of the root split search. The principal variation is left in the first context.
+SearchResult alphabeta_split(std::vector<SearchContextPtr>& contexts, ThreadPool& pool, const GameNode& root, int depth)
+{
+    auto& main_ctx = *contexts.front();
+    const auto eval_player = root.state.player_to_move;
+
+    // The same order as in `alphabeta`, in the buffers of the root ply, which the children searched from ply 1 on
+    // leave alone.
+    auto& buffers = main_ctx.buffers(0);
+    const auto& next_moves = buffers.moves;
+    const auto& child_nodes = buffers.child_nodes;
+    const auto& search_order_indices = buffers.search_order;
+    get_legal_moves(root.state, buffers.moves);
+    const size_t child_count = next_moves.size();
+    for (size_t i = 0; i < child_count; ++i) {
+        buffers.child_nodes[i] = make_move(root.state, next_moves[i]);
+    }
+    const bool on_pv = main_ctx.options.move_ordering && main_ctx.pv_hint_length > 0;
+    order_children(main_ctx, root, 0, on_pv, buffers);
+
+    auto best_mutex = std::mutex{};
+    auto best_result = SearchResult{MoveCoord{}, std::numeric_limits<int>::min()};
+    auto next_search_index = std::atomic<size_t>{0};
+    bool aborted = false;
+
+    const auto search_child = [&](SearchContext& ctx, size_t search_index) {
+        const size_t child_index = search_order_indices[search_index];
+        ctx.follow_pv = on_pv && search_index == 0;
+        int alpha = std::numeric_limits<int>::min();
+        {
+            const auto lock = std::lock_guard{best_mutex};
+            alpha = best_result.value;
+        }
+
+        const auto child_result = alphabeta<false>(ctx, eval_player, child_nodes[child_index], depth - 1, 1,
+            alpha, std::numeric_limits<int>::max());
+
+        const auto lock = std::lock_guard{best_mutex};
+        if (ctx.aborted) {
+            aborted = true;
+            return;
+        }
+        if (child_result.value > best_result.value) {
+            best_result.value = child_result.value;
+            best_result.move = to_move_coord(next_moves[child_index]);
+            main_ctx.pv[0][0] = best_result.move;
+            std::copy_n(std::begin(ctx.pv[1]), ctx.pv_length[1], std::begin(main_ctx.pv[0]) + 1);
+            main_ctx.pv_length[0] = ctx.pv_length[1] + 1;
+        }
+    };
+
+    const auto work = [&](SearchContext& ctx) {
+        const auto trace_scope = TraceScope{"root split"};
+        for (size_t search_index = next_search_index++; search_index < child_count; search_index = next_search_index++) {
+            trace_instant("root move", static_cast<int64_t>(search_index));
+            search_child(ctx, search_index);
+            if (ctx.aborted) break;
+        }
+    };
+
+    // The statistics are kept per thread.
+    const auto add_stats_since = [&](const SearchContext& ctx, uint64_t nodes_before,
+        const HashTableStats& pawn_hash_before, const HashTableStats& eval_cache_before)
+    {
+        auto stats = ctx.stats;
+        stats.nodes = ctx.nodes - nodes_before;
+        stats.pawn_hash = pawn_hash_stats() - pawn_hash_before;
+        stats.eval_cache = eval_cache_stats() - eval_cache_before;
+        const auto lock = std::lock_guard{best_mutex};
+        best_result.stats += stats;
+    };
+
+    for (auto& ctx : contexts) ctx->stats = SearchStats{};
+    const auto nodes_before = main_ctx.nodes;
+    const auto pawn_hash_before = pawn_hash_stats();
+    const auto eval_cache_before = eval_cache_stats();
+
+    // The first child alone, so that the rest are searched with a bound.
+    main_ctx.pv_length[0] = 0;
+    if constexpr (SearchStatsEnabled) {
+        ++main_ctx.stats.nodes_by_ply[0];
+    }
+    if (main_ctx.enter_node()) {
+        add_stats_since(main_ctx, nodes_before, pawn_hash_before, eval_cache_before);
+        return best_result;
+    }
+    {
+        const auto trace_scope = TraceScope{"first root move"};
+        search_child(main_ctx, next_search_index++);
+    }
+
+    if (!aborted) {
+        for (size_t i = 1; i < contexts.size(); ++i) {
+            pool.submit([&work, &add_stats_since, &ctx = *contexts[i]] {
+                const auto nodes_before = ctx.nodes;
+                const auto pawn_hash_before = pawn_hash_stats();
+                const auto eval_cache_before = eval_cache_stats();
+                work(ctx);
+                add_stats_since(ctx, nodes_before, pawn_hash_before, eval_cache_before);
+            });
+        }
+        work(main_ctx);
+        pool.wait();
+    }
+    add_stats_since(main_ctx, nodes_before, pawn_hash_before, eval_cache_before);
+
+    main_ctx.aborted = aborted;
+    return best_result;
+}
+
+} // namespace
+
+SearchReport search(const GameNode& root, const SearchLimits& limits, const SearchSignals& signals,
+    const SearchOptions& options, const SearchReportCallback& on_iteration)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto start_time = Clock::now();
+    const auto trace_scope = TraceScope{"search"};
+
+    auto report = SearchReport{};
+    if (is_terminal(root)) {
+        report.value = options.evaluate(root.state.player_to_move, root);
+        return report;
+    }
+
+    // A book move is played without searching; its value is unknown.
+    if (options.book) {
+        const auto book_move = options.book->best_move(root.state);
+        if (book_move && is_move_coord_legal(root.next_moves(), *book_move)) {
+            report.move = *book_move;
+            report.pv.assign(1, *book_move);
+            report.time = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start_time);
+            return report;
+        }
+    }
+
+    const int thread_count = std::max(1, limits.threads);
+    auto contexts = std::vector<SearchContextPtr>{};
+    for (int i = 0; i < thread_count; ++i) {
+        contexts.push_back(std::make_unique<SearchContext>());
+        contexts.back()->options = options;
+        contexts.back()->node_limit = limits.nodes;
+        contexts.back()->signals = &signals;
+    }
+    auto helper_pool = thread_count > 1 ? std::make_unique<ThreadPool>(thread_count - 1) : nullptr;
+    auto& ctx = contexts.front();
+
+    const auto max_depth = std::min(limits.depth, MaxSearchDepth);
+    for (int depth = 1; depth <= max_depth; ++depth) {
+        const auto trace_scope = TraceScope{"iteration", depth};
+        for (auto& c : contexts) {
+            c->abortable = depth > 1;
+            c->follow_pv = false;
+        }
+        ctx->follow_pv = true;
+
+        const auto result = helper_pool ?
+            alphabeta_split(contexts, *helper_pool, root, depth) :
+            alphabeta(*ctx, root, depth);
+        report.stats += result.stats;
+        report.nodes = 0;
+        for (const auto& c : contexts) report.nodes += c->nodes;
+        report.time = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start_time);
+
+        if (ctx->aborted) break;
+
+        report.move = result.move;
+        report.value = result.value;
+        report.depth = depth;
+        report.pv.assign(std::begin(ctx->pv[0]), std::begin(ctx->pv[0]) + ctx->pv_length[0]);
+
+        std::copy(std::begin(report.pv), std::end(report.pv), std::begin(ctx->pv_hint));
+        ctx->pv_hint_length = static_cast<int>(report.pv.size());
+
+        if (on_iteration) on_iteration(report);
+
+        if (mate_in_moves(report.value) != 0) break;  // A deeper search cannot find a quicker mate.
+        if (signals.stop.load() || SearchSignals::now() >= signals.soft_deadline.load()) break;
+        if (limits.nodes != 0 && std::any_of(std::begin(contexts), std::end(contexts), [&](const SearchContextPtr& c) {
+            return c->nodes >= limits.nodes;
+        })) break;
+    }
+
+    return report;
+}
+
+int mate_in_moves(int value) noexcept
+{
+    if (value >= MateValue - MaxMatePlies) return (MateValue - value + 1) / 2;
+    if (value <= -MateValue + MaxMatePlies) return -(MateValue + value) / 2;
+    return 0;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
@@ -0,0 +1,123 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+#include "rookmole/see.h"
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+namespace {
+
+// The piece standing on the target square of `m` after it has been made.
+Piece moved_piece(const GameState& s, Move m) noexcept {
+    return m.is_promotion() ? Piece::Queen : piece_of(s.square_at(m.from()));
+}
+
+} // namespace
+
+int capture_gain(const GameState& s, Move m) noexcept {
+    int value = 0;
+    if (m.flag() == MoveFlag::EnPassant) value = SeeValues[Piece::Pawn];
+    else if (m.is_capture()) value = SeeValues[piece_of(s.square_at(m.to()))];
+    if (m.is_promotion()) value += SeeValues[Piece::Queen] - SeeValues[Piece::Pawn];
+    return value;
+}
+
+int see(const GameState& s, const Bitboards& bbs, Move m) noexcept {
+    const int to = m.to();
+    const auto diagonal_sliders = bbs.by_square[Square::WhiteBishop] | bbs.by_square[Square::BlackBishop] |
+        bbs.by_square[Square::WhiteQueen] | bbs.by_square[Square::BlackQueen];
+    const auto straight_sliders = bbs.by_square[Square::WhiteRook] | bbs.by_square[Square::BlackRook] |
+        bbs.by_square[Square::WhiteQueen] | bbs.by_square[Square::BlackQueen];
+
+    auto occupied = bbs.occupied() ^ bit(m.from());
+    if (m.flag() == MoveFlag::EnPassant) {
+        occupied ^= bit(is_white(s.player_to_move) ? to - 8 : to + 8);
+    }
+
+    auto attackers =
+        (pawn_attacks_from(Player::Black, to) & bbs.of(Player::White, Piece::Pawn)) |
+        (pawn_attacks_from(Player::White, to) & bbs.of(Player::Black, Piece::Pawn)) |
+        (knight_attacks(to) & (bbs.of(Player::White, Piece::Knight) | bbs.of(Player::Black, Piece::Knight))) |
+        (king_attacks(to) & (bbs.of(Player::White, Piece::King) | bbs.of(Player::Black, Piece::King))) |
+        (bishop_attacks(to, occupied) & diagonal_sliders) |
+        (rook_attacks(to, occupied) & straight_sliders);
+
+    // The gains of the player making each capture, if the exchange stopped after it.
+    std::array<int, 33> gains;
+    gains[0] = capture_gain(s, m);
+    int depth = 0;
+    int on_target = SeeValues[moved_piece(s, m)];
+    auto player = other_player(s.player_to_move);
+
+    while (true) {
+        attackers &= occupied;
+        const auto own_attackers = attackers & bbs.of(player);
+        if (own_attackers == 0) break;
+
+        auto piece = Piece::Pawn;
+        while (!(own_attackers & bbs.of(player, piece))) piece = static_cast<Piece>(piece + 1);
+        const auto from = bbs.of(player, piece) & own_attackers;
+
+        ++depth;
+        gains[depth] = on_target - gains[depth - 1];
+        on_target = SeeValues[piece];
+
+        occupied ^= from & (~from + 1);
+        if (piece == Piece::Pawn || piece == Piece::Bishop || piece == Piece::Queen) {
+            attackers |= bishop_attacks(to, occupied) & diagonal_sliders;
+        }
+        if (piece == Piece::Rook || piece == Piece::Queen) {
+            attackers |= rook_attacks(to, occupied) & straight_sliders;
+        }
+        player = other_player(player);
+    }
+
+    // Either player may stop capturing where it is better for them.
+    while (depth > 0) {
+        --depth;
+        gains[depth] = -std::max(-gains[depth], gains[depth + 1]);
+    }
+    return gains[0];
+}
+
+int see(const GameState& s, Move m) noexcept {
+    return see(s, make_bitboards(s), m);
+}
+
+namespace {
+
+// Whether the material of the first capture alone tells `see(s, m) >= threshold`: not when even capturing for free
+// would not do, nor when even losing the capturing piece for nothing would.
+std::optional<bool> see_ge_bound(const GameState& s, Move m, int threshold) noexcept {
+    const int first_capture = capture_gain(s, m);
+    if (first_capture < threshold) return false;
+    if (first_capture - SeeValues[moved_piece(s, m)] >= threshold) return true;
+    return std::nullopt;
+}
+
+} // namespace
+
+bool see_ge(const GameState& s, Move m, int threshold) noexcept {
+    const auto bound = see_ge_bound(s, m, threshold);
+    return bound ? *bound : see(s, m) >= threshold;
+}
+
+bool see_ge(const GameState& s, const Bitboards& bbs, Move m, int threshold) noexcept {
+    const auto bound = see_ge_bound(s, m, threshold);
+    return bound ? *bound : see(s, bbs, m) >= threshold;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
@@ -11,6 +11,7 @@
 */
 
 #include "rookmole/state.h"
+#include "rookmole/bitboard.h"
 
 namespace rookmole {
 
@@ -181,58 +182,51 @@ std::ostream& operator<<(std::ostream& out, const GameState& state)
 
 //=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
 
-bool is_attacked_by(Player p, Coord c, const GameState& s) noexcept {
-    assert(is_valid(c));
-    bool attacked = false;
+namespace {
 
-    foreach_vicinity(c, [p, &s, &attacked](Coord c) {
-        if (s.get_square(c) == make_square(p, Piece::King)) { attacked = true; return false; }
-        return true;
-    });
-    if (attacked) return true;
+template<Player p>
+bool is_attacked_by(Coord c, const GameState& s) noexcept {
+    assert(is_valid(c));
+    const int index = square_index(c);
 
-    foreach_knight_attack(c, [p, &s, &attacked](Coord c) {
-        if (s.get_square(c) == make_square(p, Piece::Knight)) { attacked = true; return false; }
-        return true;
-    });
-    if (attacked) return true;
+    const auto any_of = [&s](Bitboard squares, Square sq) {
+        for (; squares != 0; squares &= squares - 1) {
+            if (s.square_at(lsb_index(squares)) == sq) return true;
+        }
+        return false;
+    };
 
-    constexpr Coord hv_dirs[] = {{0, -1}, {-1, 0}, {1, 0}, {0, 1}};
+    if (any_of(king_attacks(index), make_square(p, Piece::King))) return true;
+    if (any_of(knight_attacks(index), make_square(p, Piece::Knight))) return true;
 
-    for (const auto dir : hv_dirs) {
-        foreach_in_dir(c, dir, [p, &s, &attacked](Coord c) {
-            const auto sq = s.get_square(c);
+    // The sliding piece nearest on the ray, if any.
+    const auto attacked_along = [&s, index](Direction dir, Piece slider) {
+        bool attacked = false;
+        foreach_on_ray(index, dir, [&s, &attacked, slider](int i) {
+            const auto sq = s.square_at(i);
             attacked = (
-                sq == make_square(p, Piece::Rook) ||
+                sq == make_square(p, slider) ||
                 sq == make_square(p, Piece::Queen));
             return is_empty(sq);
         });
-        if (attacked) return true;
-    }
-
-    constexpr Coord diag_dirs[] = {{-1, -1}, {1, -1}, {-1, 1}, {1, 1}};
+        return attacked;
+    };
 
-    for (const auto dir : diag_dirs) {
-        foreach_in_dir(c, dir, [p, &s, &attacked](Coord c) {
-            const auto sq = s.get_square(c);
-            attacked = (
-                sq == make_square(p, Piece::Bishop) ||
-                sq == make_square(p, Piece::Queen));
-            return is_empty(sq);
-        });
-        if (attacked) return true;
+    for (const auto dir : StraightDirections) {
+        if (attacked_along(dir, Piece::Rook)) return true;
+    }
+    for (const auto dir : DiagonalDirections) {
+        if (attacked_along(dir, Piece::Bishop)) return true;
     }
 
-    const int forward_rank_off = is_white(s.player_to_move) ? 1 : -1;
+    // A pawn of player `p` attacks `c` from where a pawn of the opponent on `c` would attack.
+    return any_of(pawn_attacks_from(other_player(p), index), make_square(p, Piece::Pawn));
+}
 
-    for (int file_off : {-1, 1}) {
-        auto c_off = c + Coord{file_off, forward_rank_off};
-        if (is_invalid(c_off)) continue;
-        if (s.get_square(c_off) == make_square(p, Piece::Pawn))
-            return true;
-    }
+} // namespace
 
-    return false;
+bool is_attacked_by(Player p, Coord c, const GameState& s) noexcept {
+    return is_white(p) ? is_attacked_by<Player::White>(c, s) : is_attacked_by<Player::Black>(c, s);
 }
 
 Coord find_king(Player p, const GameState& s) noexcept {
@@ -249,118 +243,166 @@ Coord find_king(Player p, const GameState& s) noexcept {
 
 //=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
 
-MoveCoordVec get_legal_moves(const GameState& s)
+namespace {
+
+// The squares where a move other than the king's parries the check of the king at `king_coord`: the square of the
+// checking piece, and the squares between it and the king if it is a sliding one. None if in double check, and all if
+// not in check.
+template<Player player>
+Bitboard evasion_targets(Coord king_coord, const GameState& s) noexcept {
+    constexpr auto opponent = other_player(player);
+    const auto bbs = make_bitboards(s);
+    const auto occupied = bbs.occupied();
+    const auto king_index = square_index(king_coord);
+
+    const auto checkers =
+        (knight_attacks(king_index) & bbs.of(opponent, Piece::Knight)) |
+        (pawn_attacks_from(player, king_index) & bbs.of(opponent, Piece::Pawn)) |
+        (bishop_attacks(king_index, occupied) & (bbs.of(opponent, Piece::Bishop) | bbs.of(opponent, Piece::Queen))) |
+        (rook_attacks(king_index, occupied) & (bbs.of(opponent, Piece::Rook) | bbs.of(opponent, Piece::Queen)));
+
+    if (checkers == 0) return ~Bitboard{0};
+    if (popcount(checkers) > 1) return 0;
+    // Nothing is between the king and a checking knight or pawn.
+    return checkers | between_mask(king_index, lsb_index(checkers));
+}
+
+// Calls `cb` for every legal move of `player`, who is to move, of the given subset, until it returns false.
+// Returns false if the generation was stopped by the callback.
+// The directions and the ranks of the player are constants, so that the generation does not branch on them, and the
+// moves outside of the subset are dropped before their legality is checked.
+template<Player player, MoveGenMode mode, typename CbT>
+bool foreach_legal_move(const GameState& s, const CbT& cb)
 {
-    auto out = MoveCoordVec{};
-    out.reserve(20);
+    assert(s.player_to_move == player);
+    constexpr auto opponent = other_player(player);
+    constexpr bool captures = mode != MoveGenMode::Quiets && mode != MoveGenMode::QuietChecks;
+    constexpr bool quiets = mode != MoveGenMode::Captures;
+    bool stopped = false;
 
-    auto my_king_coord_opt = find_my_king(s);
+    auto my_king_coord_opt = find_king(player, s);
     auto en_passant_coord_opt = s.en_passant_file != 0 ?
-        Coord{s.en_passant_file, is_white(s.player_to_move) ? 6 : 3} :
+        Coord{s.en_passant_file, is_white(player) ? 6 : 3} :
         Coord::invalid();
 
-    auto add_move = [&out, &s, my_king_coord_opt](MoveCoord mc) {
-        const auto sq_from = s(mc.from);
-        assert(player_of(sq_from) == s.player_to_move);
+    auto targets = ~Bitboard{0};
+    if constexpr (mode == MoveGenMode::Evasions) {
+        if (is_valid(my_king_coord_opt)) {
+            targets = evasion_targets<player>(my_king_coord_opt, s);
+        }
+    }
+
+    auto add_move = [&cb, &stopped, &s, my_king_coord_opt, targets](Coord from, Coord to, MoveFlag flag) {
+        if (stopped) return;
+        const auto sq_from = s(from);
+        assert(player_of(sq_from) == player);
+
+        const auto move = Move{from, to, flag};
+        if constexpr (!captures) {
+            if (move.is_capture() || move.is_promotion()) return;
+        }
+        if constexpr (!quiets) {
+            if (!move.is_capture() && !move.is_promotion()) return;
+        }
+        if constexpr (mode == MoveGenMode::Evasions) {
+            // A pawn checking the king may be captured en passant, from beside it.
+            const auto target = flag == MoveFlag::EnPassant ? Coord{to.file, from.rank} : to;
+            if (piece_of(sq_from) != Piece::King && !(targets & (bit(to) | bit(target)))) return;
+        }
+
         bool is_king_in_check_after_move;
         if (is_valid(my_king_coord_opt)) {
-            auto king_coord_after_move = (piece_of(sq_from) == Piece::King) ? mc.to : my_king_coord_opt;
-            auto temp_move = ScopedPieceMover{const_cast<GameState&>(s), mc};
-            is_king_in_check_after_move = is_attacked_by_him(king_coord_after_move, s);
+            auto king_coord_after_move = (piece_of(sq_from) == Piece::King) ? to : my_king_coord_opt;
+            auto temp_move = ScopedPieceMover{const_cast<GameState&>(s), MoveCoord{from, to}};
+            // The pawn captured en passant leaves a square off the path of the move, which may uncover the king.
+            const auto en_passant_victim_coord = flag == MoveFlag::EnPassant ? Coord{to.file, from.rank} : Coord::invalid();
+            if (is_valid(en_passant_victim_coord)) {
+                const_cast<GameState&>(s).set_square(en_passant_victim_coord, Square::Empty);
+            }
+            is_king_in_check_after_move = is_attacked_by<opponent>(king_coord_after_move, s);
+            if (is_valid(en_passant_victim_coord)) {
+                const_cast<GameState&>(s).set_square(en_passant_victim_coord, make_square(opponent, Piece::Pawn));
+            }
         }
         else {
             // There is no king on the chessboard.
             is_king_in_check_after_move = false;
         }
 
-        if (!is_king_in_check_after_move)
-            out.push_back(mc);
+        if (is_king_in_check_after_move) return;
+        if constexpr (mode == MoveGenMode::QuietChecks) {
+            if (!is_king_in_check(make_move<player>(s, move).state)) return;
+        }
+        if (!cb(move))
+            stopped = true;
+    };
+
+    // The moves of a sliding piece at `c` in the direction `dir`, up to the first piece on the way.
+    auto add_slides = [&stopped, &s, &add_move](Coord c, Direction dir) {
+        foreach_on_ray(square_index(c), dir, [&stopped, &s, &add_move, c](int i) {
+            const auto sq_to = s.square_at(i);
+            if (is_empty(sq_to) || player_of(sq_to) == opponent)
+                add_move(c, coord_of(i), is_empty(sq_to) ? MoveFlag::Quiet : MoveFlag::Capture);
+            return is_empty(sq_to) && !stopped;
+        });
     };
 
-    s.foreach_piece([&out, &s, &add_move, my_king_coord_opt, en_passant_coord_opt](Coord c, Player p, Piece pc) {
-        if (p != s.player_to_move) return;
-        const auto opponent = other_player(p);
+    s.foreach_piece([&stopped, &s, &add_move, &add_slides, my_king_coord_opt, en_passant_coord_opt, targets](Coord c, Player p, Piece pc) {
+        if (stopped || p != player) return;
+        if (targets == 0 && pc != Piece::King) return;  // Double check.
 
         switch (pc) {
             case Piece::Pawn: {
                 assert(c.rank > 1 && c.rank < 8);
-                const int forward_rank_off = is_white(p) ? 1 : -1;
-                auto c_fwd = c + Coord{0, forward_rank_off};
-                assert(is_valid(c_fwd));
+                constexpr int forward = is_white(player) ? 8 : -8;  // A rank up the board, in square indices.
+                const bool promotion = c.rank == (is_white(player) ? 7 : 2);
+                const int from = square_index(c);
 
-                if (is_empty(s(c_fwd))) {
-                    add_move({c, c_fwd});
+                if (is_empty(s.square_at(from + forward))) {
+                    add_move(c, coord_of(from + forward), promotion ? MoveFlag::Promotion : MoveFlag::Quiet);
 
-                    if (c.rank == (is_white(p) ? 2 : 7)) {
-                        auto c_2fwd = c_fwd + Coord{0, forward_rank_off};
-                        if (is_valid(c_2fwd) && is_empty(s(c_2fwd))) {
-                            add_move({c, c_2fwd});
-                        }
+                    // From the second rank, the square two ahead is on the board.
+                    if (c.rank == (is_white(player) ? 2 : 7) && is_empty(s.square_at(from + 2 * forward))) {
+                        add_move(c, coord_of(from + 2 * forward), MoveFlag::DoublePush);
                     }
                 }
 
-                for (int i : {-1, 1}) {
-                    auto c_d = c + Coord{i, forward_rank_off};
-                    if (is_invalid(c_d)) continue;
-
-                    const auto sq_d = s(c_d);
-                    if ((!is_empty(sq_d) && (player_of(sq_d) == opponent)) ||
-                        (c_d == en_passant_coord_opt))
-                    {
-                        add_move({c, c_d});
+                foreach_bit(pawn_attacks_from(player, from), [&s, &add_move, c, promotion, en_passant_coord_opt](int i) {
+                    const auto c_d = coord_of(i);
+                    const auto sq_d = s.square_at(i);
+                    if (!is_empty(sq_d) && (player_of(sq_d) == opponent)) {
+                        add_move(c, c_d, promotion ? MoveFlag::PromotionCapture : MoveFlag::Capture);
                     }
-                }
+                    else if (c_d == en_passant_coord_opt) {
+                        add_move(c, c_d, MoveFlag::EnPassant);
+                    }
+                });
 
                 break;
             }
 
             case Piece::Knight: {
-                foreach_knight_attack(c, [&s, &add_move, c, opponent](Coord c_to) {
-                    const auto sq_to = s(c_to);
+                foreach_bit(knight_attacks(c), [&s, &add_move, c](int i) {
+                    const auto sq_to = s.square_at(i);
                     if (is_empty(sq_to) || player_of(sq_to) == opponent)
-                        add_move({c, c_to});
-                    return true;
+                        add_move(c, coord_of(i), is_empty(sq_to) ? MoveFlag::Quiet : MoveFlag::Capture);
                 });
                 break;
             }
 
             case Piece::Bishop: {
-                constexpr Coord diag_dirs[] = {{-1, -1}, {1, -1}, {-1, 1}, {1, 1}};
-                for (const auto dir : diag_dirs) {
-                    foreach_in_dir(c, dir, [&s, &add_move, c, opponent](Coord c_to) {
-                        const auto sq_to = s(c_to);
-                        if (is_empty(sq_to) || player_of(sq_to) == opponent)
-                            add_move({c, c_to});
-                        return is_empty(sq_to);
-                    });
-                }
+                for (const auto dir : DiagonalDirections) add_slides(c, dir);
                 break;
             }
 
             case Piece::Rook: {
-                constexpr Coord hv_dirs[] = {{0, -1}, {-1, 0}, {1, 0}, {0, 1}};
-                for (const auto dir : hv_dirs) {
-                    foreach_in_dir(c, dir, [&s, &add_move, c, opponent](Coord c_to) {
-                        const auto sq_to = s(c_to);
-                        if (is_empty(sq_to) || player_of(sq_to) == opponent)
-                            add_move({c, c_to});
-                        return is_empty(sq_to);
-                    });
-                }
+                for (const auto dir : StraightDirections) add_slides(c, dir);
                 break;
             }
 
             case Piece::Queen: {
-                constexpr Coord all_dirs[] = {
-                    {-1, -1}, {0, -1}, {1, -1}, {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1} };
-                for (const auto dir : all_dirs) {
-                    foreach_in_dir(c, dir, [&s, &add_move, c, opponent](Coord c_to) {
-                        const auto sq_to = s(c_to);
-                        if (is_empty(sq_to) || player_of(sq_to) == opponent)
-                            add_move({c, c_to});
-                        return is_empty(sq_to);
-                    });
-                }
+                for (const auto dir : DiagonalDirections) add_slides(c, dir);
+                for (const auto dir : StraightDirections) add_slides(c, dir);
                 break;
             }
 
@@ -368,23 +410,22 @@ MoveCoordVec get_legal_moves(const GameState& s)
                 assert(is_valid(my_king_coord_opt));
                 assert(c == my_king_coord_opt);
 
-                foreach_vicinity(c, [&s, &add_move, c, opponent](Coord c_to) {
-                    const auto sq_to = s(c_to);
+                foreach_bit(king_attacks(c), [&s, &add_move, c](int i) {
+                    const auto sq_to = s.square_at(i);
                     if (is_empty(sq_to) || player_of(sq_to) == opponent)
-                        add_move({c, c_to});
-                    return true;
+                        add_move(c, coord_of(i), is_empty(sq_to) ? MoveFlag::Quiet : MoveFlag::Capture);
                 });
 
-                bool a_castling_possible = is_white(s.player_to_move) ?
+                bool a_castling_possible = is_white(player) ?
                     !s.a1_castling_forbidden : !s.a8_castling_forbidden;
-                bool h_castling_possible = is_white(s.player_to_move) ?
+                bool h_castling_possible = is_white(player) ?
                     !s.h1_castling_forbidden : !s.h8_castling_forbidden;
 
-                if ((a_castling_possible || h_castling_possible) &&
-                    c == (is_white(s.player_to_move) ? Coord{"e1"} : Coord{"e8"}) &&
-                    !is_attacked_by_him(my_king_coord_opt, s))
+                if (quiets && !stopped && (a_castling_possible || h_castling_possible) &&
+                    c == (is_white(player) ? Coord{"e1"} : Coord{"e8"}) &&
+                    !is_attacked_by<opponent>(my_king_coord_opt, s))
                 {
-                    const int8_t castling_rank = is_white(s.player_to_move) ? 1 : 8;
+                    constexpr int8_t castling_rank = is_white(player) ? 1 : 8;
                     const auto c_a = Coord{1, castling_rank};
                     const auto c_h = Coord{8, castling_rank};
                     const auto sq_a = s(c_a);
@@ -394,52 +435,39 @@ MoveCoordVec get_legal_moves(const GameState& s)
                         a_castling_possible = false;
                     }
 
-                    if (a_castling_possible) {
-                        for (int file = 2; file < c.file; ++file) {
-                            if (!is_empty(s({file, castling_rank}))) {
-                                a_castling_possible = false;
-                                break;
-                            }
+                    const auto all_empty = [&s](Bitboard squares) {
+                        for (; squares != 0; squares &= squares - 1) {
+                            if (!is_empty(s.square_at(lsb_index(squares)))) return false;
                         }
-                    }
-
-                    if (a_castling_possible) {
-                        for (int file = 1; file < c.file; ++file) {
-                            if (is_attacked_by_him({file, castling_rank}, s)) {
-                                a_castling_possible = false;
-                                break;
-                            }
+                        return true;
+                    };
+                    // The king may not pass an attacked square, unlike the rook.
+                    const auto none_attacked = [&s](Bitboard squares) {
+                        for (; squares != 0; squares &= squares - 1) {
+                            if (is_attacked_by<opponent>(coord_of(lsb_index(squares)), s)) return false;
                         }
-                    }
+                        return true;
+                    };
+                    const int king_index = square_index(c);
+
+                    a_castling_possible = a_castling_possible &&
+                        all_empty(between_mask(king_index, square_index(c_a))) &&
+                        none_attacked(between_mask(king_index, king_index - 2) | bit(king_index - 2));
 
                     if (a_castling_possible) {
-                        add_move({c, {c.file - 2, c.rank}});
+                        add_move(c, {c.file - 2, c.rank}, MoveFlag::QueenCastling);
                     }
 
                     if (is_empty(sq_h) || player_of(sq_h) == opponent || piece_of(sq_h) != Piece::Rook) {
                         h_castling_possible = false;
                     }
 
-                    if (h_castling_possible) {
-                        for (int file = c.file + 1; file <= 7; ++file) {
-                            if (!is_empty(s({file, castling_rank}))) {
-                                h_castling_possible = false;
-                                break;
-                            }
-                        }
-                    }
-
-                    if (h_castling_possible) {
-                        for (int file = c.file + 1; file <= 8; ++file) {
-                            if (is_attacked_by_him({file, castling_rank}, s)) {
-                                h_castling_possible = false;
-                                break;
-                            }
-                        }
-                    }
+                    h_castling_possible = h_castling_possible &&
+                        all_empty(between_mask(king_index, square_index(c_h))) &&
+                        none_attacked(between_mask(king_index, king_index + 2) | bit(king_index + 2));
 
                     if (h_castling_possible) {
-                        add_move({c, {c.file + 2, c.rank}});
+                        add_move(c, {c.file + 2, c.rank}, MoveFlag::KingCastling);
                     }
                 }
                 break;
@@ -448,113 +476,217 @@ MoveCoordVec get_legal_moves(const GameState& s)
         }
     });
 
+    return !stopped;
+}
+
+template<typename CbT>
+bool foreach_legal_move(const GameState& s, const CbT& cb)
+{
+    return is_white(s.player_to_move) ?
+        foreach_legal_move<Player::White, MoveGenMode::Legal>(s, cb) :
+        foreach_legal_move<Player::Black, MoveGenMode::Legal>(s, cb);
+}
+
+} // namespace
+
+MoveCoordVec get_legal_moves(const GameState& s)
+{
+    auto out = MoveCoordVec{};
+    out.reserve(20);
+    foreach_legal_move(s, [&out](Move m) { out.push_back(to_move_coord(m)); return true; });
     return out;
 }
 
+template<Player player, MoveGenMode mode>
+void get_legal_moves(const GameState& s, MoveList& out) noexcept
+{
+    out.clear();
+    foreach_legal_move<player, mode>(s, [&out](Move m) { out.push_back(m); return true; });
+}
+
+template void get_legal_moves<Player::White, MoveGenMode::Legal>(const GameState& s, MoveList& out) noexcept;
+template void get_legal_moves<Player::Black, MoveGenMode::Legal>(const GameState& s, MoveList& out) noexcept;
+template void get_legal_moves<Player::White, MoveGenMode::Captures>(const GameState& s, MoveList& out) noexcept;
+template void get_legal_moves<Player::Black, MoveGenMode::Captures>(const GameState& s, MoveList& out) noexcept;
+template void get_legal_moves<Player::White, MoveGenMode::Quiets>(const GameState& s, MoveList& out) noexcept;
+template void get_legal_moves<Player::Black, MoveGenMode::Quiets>(const GameState& s, MoveList& out) noexcept;
+template void get_legal_moves<Player::White, MoveGenMode::Evasions>(const GameState& s, MoveList& out) noexcept;
+template void get_legal_moves<Player::Black, MoveGenMode::Evasions>(const GameState& s, MoveList& out) noexcept;
+template void get_legal_moves<Player::White, MoveGenMode::QuietChecks>(const GameState& s, MoveList& out) noexcept;
+template void get_legal_moves<Player::Black, MoveGenMode::QuietChecks>(const GameState& s, MoveList& out) noexcept;
+
+void get_legal_moves(const GameState& s, MoveList& out) noexcept
+{
+    if (is_white(s.player_to_move)) get_legal_moves<Player::White>(s, out);
+    else get_legal_moves<Player::Black>(s, out);
+}
+
+bool has_any_legal_move(const GameState& s) noexcept
+{
+    return !foreach_legal_move(s, [](Move) { return false; });
+}
+
+bool is_king_in_check(const GameState& s) noexcept
+{
+    const auto my_king_coord_opt = find_my_king(s);
+    return is_valid(my_king_coord_opt) && is_attacked_by_him(my_king_coord_opt, s);
+}
+
 //=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
 
-GameNode make_start_node() {
-    auto state = make_start_state();
-    auto legal_moves = get_legal_moves(state);
-    return GameNode{std::move(state), std::move(legal_moves), false};
+const MoveCoordVec& GameNode::next_moves() const
+{
+    if (!_next_moves) {
+        _next_moves = get_legal_moves(state);
+    }
+    return *_next_moves;
 }
 
-GameNode make_move(GameState s, MoveCoord m) {
-    assert(is_move_coord_legal(get_legal_moves(s), m) && "Illegal move");
+bool GameNode::king_in_check() const noexcept
+{
+    if (!_king_in_check) {
+        _king_in_check = is_king_in_check(state);
+    }
+    return *_king_in_check;
+}
 
-    const auto sq_from = s.get_square(m.from);
-    assert(!is_empty(sq_from));
-    assert(s.player_to_move == player_of(sq_from));
-    const auto moved_piece = piece_of(sq_from);
-
-    s.set_square(m.from, Square::Empty);
-    s.set_square(m.to, sq_from);
-
-    if (s.en_passant_file != 0) {
-        auto en_passant_coord = Coord{s.en_passant_file, is_white(s.player_to_move) ? 6 : 3};
-        if (m.to == en_passant_coord) {
-            if (moved_piece == Piece::Pawn) {
-                const auto en_passtant_culprit_coord = en_passant_coord + Coord{0, is_white(s.player_to_move) ? -1 : 1 };
-                assert(player_of(s(en_passtant_culprit_coord)) == other_player(s.player_to_move));
-                assert(piece_of(s(en_passtant_culprit_coord)) == Piece::Pawn);
-                s.set_square(en_passtant_culprit_coord, Square::Empty);
-            }
-        }
+bool GameNode::has_any_legal_move() const noexcept
+{
+    if (_next_moves) {
+        return !_next_moves->empty();
+    }
+    if (!_has_any_legal_move) {
+        _has_any_legal_move = rookmole::has_any_legal_move(state);
     }
+    return *_has_any_legal_move;
+}
 
-    // Castling.
-    {
-        if (moved_piece == Piece::King) {
-            if (static_cast<int>(m.from.file) - 2 == m.to.file) {
-                assert(m.from == (is_white(s.player_to_move) ? Coord{"e1"} : Coord{"e8"}));
-                assert(m.to == (is_white(s.player_to_move) ? Coord{"c1"} : Coord{"c8"}));
-                assert(is_white(s.player_to_move) ? !s.a1_castling_forbidden : !s.a8_castling_forbidden);
-                const int castling_rank = m.from.rank;
-                assert(!is_empty(s({1, castling_rank})));
-                assert(player_of(s({1, castling_rank})) == s.player_to_move);
-                assert(piece_of(s({1, castling_rank})) == Piece::Rook);
-                s.set_square({1, castling_rank}, Square::Empty);
-                s.set_square({4, castling_rank}, make_square(s.player_to_move, Piece::Rook));
-            }
-            else if (static_cast<int>(m.from.file) + 2 == m.to.file) {
-                assert(m.from == (is_white(s.player_to_move) ? Coord{"e1"} : Coord{"e8"}));
-                assert(m.to == (is_white(s.player_to_move) ? Coord{"g1"} : Coord{"g8"}));
-                assert(is_white(s.player_to_move) ? !s.h1_castling_forbidden : !s.h8_castling_forbidden);
-                const int castling_rank = m.from.rank;
-                assert(!is_empty(s({8, castling_rank})));
-                assert(player_of(s({8, castling_rank})) == s.player_to_move);
-                assert(piece_of(s({8, castling_rank})) == Piece::Rook);
-                s.set_square({8, castling_rank}, Square::Empty);
-                s.set_square({6, castling_rank}, make_square(s.player_to_move, Piece::Rook));
-            }
+GameNode make_start_node() {
+    return GameNode{make_start_state()};
+}
 
-            if (is_white(s.player_to_move)) {
-                s.a1_castling_forbidden = s.h1_castling_forbidden = true;
-            } else {
-                s.h1_castling_forbidden = s.h8_castling_forbidden = true;
-            }
+Move to_move(const GameState& s, MoveCoord m) noexcept {
+    const auto sq_from = s.get_square(m.from);
+    assert(!is_empty(sq_from));
+    const bool capture = !is_empty(s.get_square(m.to));
+
+    auto flag = capture ? MoveFlag::Capture : MoveFlag::Quiet;
+    if (piece_of(sq_from) == Piece::Pawn) {
+        if (m.to.rank == 1 || m.to.rank == 8) {
+            flag = capture ? MoveFlag::PromotionCapture : MoveFlag::Promotion;
+        }
+        else if (abs(m.from.rank - m.to.rank) == 2) {
+            flag = MoveFlag::DoublePush;
         }
-        else if (moved_piece == Piece::Rook) {
-            if (m.from == Coord{"a1"}) { s.a1_castling_forbidden = true; }
-            else if (m.from == Coord{"a8"}) { s.a8_castling_forbidden = true; }
-            else if (m.from == Coord{"h1"}) { s.h1_castling_forbidden = true; }
-            else if (m.from == Coord{"h8"}) { s.h8_castling_forbidden = true; }
+        else if (m.from.file != m.to.file && !capture) {
+            flag = MoveFlag::EnPassant;
         }
     }
+    else if (piece_of(sq_from) == Piece::King && abs(m.from.file - m.to.file) == 2) {
+        flag = m.to.file > m.from.file ? MoveFlag::KingCastling : MoveFlag::QueenCastling;
+    }
+    return Move{m.from, m.to, flag};
+}
 
-    // For a pawn's long leap, mark the possible en passant file for the opponent.
-    {
-        const bool en_passant = moved_piece == Piece::Pawn && abs(m.from.rank - m.to.rank) == 2;
-        s.en_passant_file = en_passant ? m.from.file : 0;
+template<Player player>
+GameNode make_move(GameState s, Move m) noexcept {
+    assert((!foreach_legal_move<player, MoveGenMode::Legal>(s, [m](Move legal) { return legal != m; })) && "Illegal move");
+    constexpr auto opponent = other_player(player);
+    constexpr int8_t home_rank = is_white(player) ? 1 : 8;
+
+    const auto from = coord_of(m.from());
+    const auto to = coord_of(m.to());
+    const auto sq_from = s.get_square(from);
+    assert(!is_empty(sq_from));
+    assert(player_of(sq_from) == player);
+
+    s.set_square(from, Square::Empty);
+    s.set_square(to, m.is_promotion() ? make_square(player, Piece::Queen) : sq_from);
+
+    switch (m.flag()) {
+        case MoveFlag::EnPassant: {
+            const auto en_passant_victim_coord = Coord{to.file, from.rank};
+            assert(s(en_passant_victim_coord) == make_square(opponent, Piece::Pawn));
+            s.set_square(en_passant_victim_coord, Square::Empty);
+            break;
+        }
+        case MoveFlag::KingCastling:
+            assert(s({8, home_rank}) == make_square(player, Piece::Rook));
+            s.set_square({8, home_rank}, Square::Empty);
+            s.set_square({6, home_rank}, make_square(player, Piece::Rook));
+            break;
+        case MoveFlag::QueenCastling:
+            assert(s({1, home_rank}) == make_square(player, Piece::Rook));
+            s.set_square({1, home_rank}, Square::Empty);
+            s.set_square({4, home_rank}, make_square(player, Piece::Rook));
+            break;
+        default:
+            break;
     }
 
-    // Pawn to Queen promotion.
-    {
-        const int8_t promotion_rank = is_white(s.player_to_move) ? 8 : 1;
-        if (moved_piece == Piece::Pawn && m.to.rank == promotion_rank) {
-            s.set_square(m.to, make_square(s.player_to_move, Piece::Queen));
+    // Castling rights: lost by moving the king, or a rook from its corner, or by a rook captured there.
+    if (piece_of(sq_from) == Piece::King) {
+        if constexpr (is_white(player)) {
+            s.a1_castling_forbidden = s.h1_castling_forbidden = true;
+        } else {
+            s.a8_castling_forbidden = s.h8_castling_forbidden = true;
         }
     }
+    for (const auto c : {from, to}) {
+        if (c == Coord{"a1"}) { s.a1_castling_forbidden = true; }
+        else if (c == Coord{"a8"}) { s.a8_castling_forbidden = true; }
+        else if (c == Coord{"h1"}) { s.h1_castling_forbidden = true; }
+        else if (c == Coord{"h8"}) { s.h8_castling_forbidden = true; }
+    }
+
+    // For a pawn's long leap, mark the possible en passant file for the opponent.
+    s.en_passant_file = m.flag() == MoveFlag::DoublePush ? from.file : 0;
 
     // Switch to the opponent.
-    s.player_to_move = other_player(s.player_to_move);
-    if (is_white(s.player_to_move)) ++s.move_count;
+    s.player_to_move = opponent;
+    if constexpr (is_black(player)) ++s.move_count;
+
+    // The check and the next legal moves are determined on demand.
+    return GameNode{s};
+}
+
+template GameNode make_move<Player::White>(GameState s, Move m) noexcept;
+template GameNode make_move<Player::Black>(GameState s, Move m) noexcept;
+
+GameNode make_move(GameState s, Move m) noexcept {
+    return is_white(s.player_to_move) ? make_move<Player::White>(s, m) : make_move<Player::Black>(s, m);
+}
 
-    // Determine whether the king is in check.
-    const bool king_in_check = [&s, moved_piece] {
-        auto my_king_coord_opt = find_my_king(s);
-        if (is_invalid(my_king_coord_opt)) return false;
-        return is_attacked_by_him(my_king_coord_opt, s);
-    }();
+GameNode make_move(GameState s, MoveCoord m) {
+    return make_move(s, to_move(s, m));
+}
+
+bool is_terminal(const GameNode& n) noexcept {
+    return n.state.move_count == 80 || !n.has_any_legal_move();
+}
 
-    // Find next legal moves.
-    auto next_moves = get_legal_moves(s);
+namespace {
 
-    return {s, std::move(next_moves), king_in_check};
+// With the players resolved at compile time, as they alternate.
+template<Player player>
+uint64_t perft(const GameState& s, int depth) noexcept {
+    if (depth == 0) return 1;
+
+    auto moves = MoveList{};
+    get_legal_moves<player>(s, moves);
+    if (depth == 1) return moves.size();
+
+    uint64_t leaves = 0;
+    for (const auto move : moves) {
+        leaves += perft<other_player(player)>(make_move<player>(s, move).state, depth - 1);
+    }
+    return leaves;
 }
 
-bool is_terminal(GameNode n) noexcept {
-    return n.next_moves.empty() || n.state.move_count == 80;
+} // namespace
+
+uint64_t perft(const GameState& s, int depth) noexcept {
+    return is_white(s.player_to_move) ? perft<Player::White>(s, depth) : perft<Player::Black>(s, depth);
 }
 
 //=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
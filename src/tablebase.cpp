@@ -0,0 +1,645 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#include "rookmole/tablebase.h"
+#include "rookmole/bitboard.h"
+#include "rookmole/thread_pool.h"
+#include "little_endian.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+namespace {
+
+constexpr char TablebaseMagic[4] = {'R', 'M', 'T', 'B'};
+constexpr uint32_t TablebaseVersion = 1;
+constexpr size_t TablebaseHeaderSize = 16;
+constexpr size_t SignatureOffset = 8;
+
+constexpr uint8_t DrawEntry = 0;
+constexpr uint8_t IllegalEntry = 255;
+constexpr int MaxDistance = MaxTablebaseMatePlies;  // Stored as 1..254.
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// The board of a tablebase position: just a few pieces, with a square index each.
+
+struct TbPiece {
+    Player player;
+    Piece piece;
+    int square;
+};
+
+struct TbPieces {
+    std::array<TbPiece, MaxTablebasePieces> pieces;
+    int count = 0;
+
+    const TbPiece* begin() const noexcept { return pieces.data(); }
+    const TbPiece* end() const noexcept { return pieces.data() + count; }
+    TbPiece* begin() noexcept { return pieces.data(); }
+    TbPiece* end() noexcept { return pieces.data() + count; }
+};
+
+// Kings go first, then the heavier pieces.
+int piece_rank(Piece pc) noexcept {
+    switch (pc) {
+        case Piece::King: return 0;
+        case Piece::Queen: return 1;
+        case Piece::Rook: return 2;
+        case Piece::Bishop: return 3;
+        case Piece::Knight: return 4;
+        default: return 5;
+    }
+}
+
+constexpr char PieceLetters[] = " PNBRQK";
+
+std::optional<Piece> piece_of_letter(char c) noexcept {
+    for (int pc = Piece::Pawn; pc <= Piece::King; ++pc) {
+        if (PieceLetters[pc] == c) return static_cast<Piece>(pc);
+    }
+    return std::nullopt;
+}
+
+// Sorts the pieces into the order of their signature: white, then black, each starting with the king.
+// An insertion sort, for a few pieces (and std::sort makes GCC see indices past the array).
+void canonicalize(TbPieces& ps) noexcept {
+    const auto precedes = [](const TbPiece& p1, const TbPiece& p2) {
+        if (p1.player != p2.player) return p1.player < p2.player;
+        return piece_rank(p1.piece) < piece_rank(p2.piece);
+    };
+    for (int i = 1; i < ps.count; ++i) {
+        const auto piece = ps.pieces[i];
+        int j = i;
+        for (; j > 0 && precedes(piece, ps.pieces[j - 1]); --j) ps.pieces[j] = ps.pieces[j - 1];
+        ps.pieces[j] = piece;
+    }
+}
+
+std::string_view signature_of(const TbPieces& ps, std::array<char, MaxTablebasePieces>& buffer) noexcept {
+    for (int i = 0; i < ps.count; ++i) {
+        buffer[i] = PieceLetters[ps.pieces[i].piece];
+    }
+    return std::string_view{buffer.data(), static_cast<size_t>(ps.count)};
+}
+
+std::optional<TbPieces> parse_signature(std::string_view signature) noexcept {
+    if (signature.size() < 2 || signature.size() > MaxTablebasePieces || signature[0] != 'K') return std::nullopt;
+
+    auto ps = TbPieces{};
+    auto player = Player::White;
+    for (size_t i = 0; i < signature.size(); ++i) {
+        const auto piece = piece_of_letter(signature[i]);
+        if (!piece) return std::nullopt;
+        if (i > 0 && *piece == Piece::King) {
+            if (is_black(player)) return std::nullopt;
+            player = Player::Black;
+        }
+        ps.pieces[ps.count++] = TbPiece{player, *piece, 0};
+    }
+    if (is_white(player)) return std::nullopt;
+
+    // Only canonical signatures, so that every material has a single name: sorted, the stronger side white.
+    auto sorted = ps;
+    canonicalize(sorted);
+    auto buffer = std::array<char, MaxTablebasePieces>{};
+    if (signature_of(sorted, buffer) != signature) return std::nullopt;
+    const auto black_king = signature.find('K', 1);
+    const auto white_pieces = signature.substr(1, black_king - 1);
+    const auto black_pieces = signature.substr(black_king + 1);
+    if (white_pieces.size() < black_pieces.size()) return std::nullopt;
+    if (white_pieces.size() == black_pieces.size()) {
+        for (size_t i = 0; i < white_pieces.size(); ++i) {
+            const int white_rank = piece_rank(*piece_of_letter(white_pieces[i]));
+            const int black_rank = piece_rank(*piece_of_letter(black_pieces[i]));
+            if (white_rank != black_rank) {
+                if (white_rank > black_rank) return std::nullopt;
+                break;
+            }
+        }
+    }
+    return ps;
+}
+
+constexpr size_t table_size(int piece_count) noexcept { return size_t{2} << (6 * piece_count); }
+
+size_t index_of(const TbPieces& ps, Player player_to_move) noexcept {
+    size_t index = 0;
+    for (int i = ps.count - 1; i >= 0; --i) {
+        index = 64 * index + ps.pieces[i].square;
+    }
+    return 2 * index + player_to_move;
+}
+
+// Decodes an index of a table, the pieces of which are given by `layout`.
+TbPieces pieces_of(const TbPieces& layout, size_t index) noexcept {
+    auto ps = layout;
+    index /= 2;
+    for (auto& p : ps) {
+        p.square = static_cast<int>(index % 64);
+        index /= 64;
+    }
+    return ps;
+}
+
+bool is_trivial_draw(const TbPieces& ps) noexcept {
+    if (ps.count == 2) return true;
+    if (ps.count != 3) return false;
+    const auto piece = std::max_element(ps.begin(), ps.end(), [](const TbPiece& p1, const TbPiece& p2) {
+        return piece_rank(p1.piece) < piece_rank(p2.piece);
+    })->piece;
+    return piece == Piece::Bishop || piece == Piece::Knight;
+}
+
+std::optional<TablebaseProbe> decode_entry(uint8_t entry) noexcept {
+    if (entry == IllegalEntry) return std::nullopt;
+    if (entry == DrawEntry) return TablebaseProbe{};
+    const int plies = entry - 1;
+    return TablebaseProbe{plies % 2 ? TablebaseWdl::Win : TablebaseWdl::Loss, plies};
+}
+
+using TableFinder = std::function<const uint8_t*(std::string_view signature)>;
+
+// Looks the pieces up in the table of their material or, failing that, in the one with the colors reversed.
+template<typename FindT>
+std::optional<TablebaseProbe> probe_pieces(TbPieces ps, Player player_to_move, const FindT& find_table) noexcept {
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        canonicalize(ps);
+        auto buffer = std::array<char, MaxTablebasePieces>{};
+        if (const auto* values = find_table(signature_of(ps, buffer))) {
+            return decode_entry(values[index_of(ps, player_to_move)]);
+        }
+
+        for (auto& p : ps) {
+            p.player = other_player(p.player);
+            p.square ^= 56;
+        }
+        player_to_move = other_player(player_to_move);
+    }
+    if (is_trivial_draw(ps)) return TablebaseProbe{};
+    return std::nullopt;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+Bitboard occupancy(const TbPieces& ps) noexcept {
+    Bitboard occupied = 0;
+    for (const auto& p : ps) occupied |= bit(p.square);
+    return occupied;
+}
+
+Bitboard attacks_of(const TbPiece& p, Bitboard occupied) noexcept {
+    const auto c = coord_of(p.square);
+    switch (p.piece) {
+        case Piece::Pawn: return pawn_attacks(p.player, bit(p.square));
+        case Piece::Knight: return knight_attacks(c);
+        case Piece::Bishop: return bishop_attacks(c, occupied);
+        case Piece::Rook: return rook_attacks(c, occupied);
+        case Piece::Queen: return queen_attacks(c, occupied);
+        case Piece::King: return king_attacks(c);
+        default:
+            assert(false);
+            return 0;
+    }
+}
+
+bool is_in_check(const TbPieces& ps, Player p) noexcept {
+    const auto occupied = occupancy(ps);
+    const auto king = std::find_if(ps.begin(), ps.end(), [p](const TbPiece& tp) {
+        return tp.player == p && tp.piece == Piece::King;
+    });
+    assert(king != ps.end());
+    for (const auto& attacker : ps) {
+        if (attacker.player != p && (attacks_of(attacker, occupied) & bit(king->square))) return true;
+    }
+    return false;
+}
+
+bool is_legal(const TbPieces& ps, Player player_to_move) noexcept {
+    constexpr Bitboard PromotionRanks = rank_bitboard(1) | rank_bitboard(8);
+    Bitboard occupied = 0;
+    for (const auto& p : ps) {
+        if (occupied & bit(p.square)) return false;
+        if (p.piece == Piece::Pawn && (bit(p.square) & PromotionRanks)) return false;
+        occupied |= bit(p.square);
+    }
+    return !is_in_check(ps, other_player(player_to_move));
+}
+
+// Calls `cb(child, converted)` for each legal move. A converted position, after a capture or a promotion (to a
+// queen only, as in `get_legal_moves`), belongs to another table.
+template<typename CbT>
+void foreach_move(const TbPieces& ps, Player player_to_move, const CbT& cb) noexcept {
+    constexpr Bitboard PromotionRanks = rank_bitboard(1) | rank_bitboard(8);
+    const auto occupied = occupancy(ps);
+    Bitboard own = 0;
+    for (const auto& p : ps) {
+        if (p.player == player_to_move) own |= bit(p.square);
+    }
+
+    for (int i = 0; i < ps.count; ++i) {
+        const auto& p = ps.pieces[i];
+        if (p.player != player_to_move) continue;
+
+        Bitboard targets;
+        if (p.piece == Piece::Pawn) {
+            const auto single = shift_forward(p.player, bit(p.square)) & ~occupied;
+            const auto double_rank = rank_bitboard(is_white(p.player) ? 3 : 6);
+            const auto twice = shift_forward(p.player, single & double_rank) & ~occupied;
+            targets = single | twice | (pawn_attacks(p.player, bit(p.square)) & occupied & ~own);
+        }
+        else {
+            targets = attacks_of(p, occupied) & ~own;
+        }
+
+        foreach_bit(targets, [&](int to) {
+            auto child = ps;
+            child.pieces[i].square = to;
+            bool converted = false;
+            if (p.piece == Piece::Pawn && (bit(to) & PromotionRanks)) {
+                child.pieces[i].piece = Piece::Queen;
+                converted = true;
+            }
+            if (occupied & bit(to)) {
+                const auto captured = std::find_if(child.begin(), child.end(), [&](const TbPiece& tp) {
+                    return tp.square == to && tp.player != player_to_move;
+                });
+                assert(captured != child.end() && captured->piece != Piece::King);
+                std::copy(captured + 1, child.end(), captured);
+                --child.count;
+                converted = true;
+            }
+            if (!is_in_check(child, player_to_move)) cb(child, converted);
+        });
+    }
+}
+
+// Calls `cb(parent)` for each position from which the player who has just moved could have reached this one,
+// without capturing or promoting. Illegal parents are included.
+template<typename CbT>
+void foreach_unmove(const TbPieces& ps, Player player_to_move, const CbT& cb) noexcept {
+    const auto mover = other_player(player_to_move);
+    const auto occupied = occupancy(ps);
+
+    for (int i = 0; i < ps.count; ++i) {
+        const auto& p = ps.pieces[i];
+        if (p.player != mover) continue;
+
+        Bitboard origins;
+        if (p.piece == Piece::Pawn) {
+            const auto back = shift_forward(player_to_move, bit(p.square)) & ~occupied;
+            const auto double_rank = rank_bitboard(is_white(mover) ? 3 : 6);
+            const auto twice_back = shift_forward(player_to_move, back & double_rank) & ~occupied;
+            origins = (back | twice_back) & ~rank_bitboard(is_white(mover) ? 1 : 8);
+        }
+        else {
+            origins = attacks_of(p, occupied) & ~occupied;
+        }
+
+        foreach_bit(origins, [&](int from) {
+            auto parent = ps;
+            parent.pieces[i].square = from;
+            cb(parent);
+        });
+    }
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Retrograde analysis: the mates are found first, then the positions are resolved in the order of their
+// distance to mate. A position is won at distance N+1 as soon as one of its children is lost at N, and lost at
+// N+1 once the last of its moves is found to lead to a won child, N being the longest of them.
+class TablebaseGenerator {
+    TbPieces _layout;
+    size_t _size;
+    TableFinder _find_table;
+    ThreadPool _pool;
+
+    std::unique_ptr<std::atomic<uint8_t>[]> _entries;    // 0 while unresolved.
+    std::unique_ptr<std::atomic<uint8_t>[]> _remaining;  // The moves not yet known to lead to a won child.
+    std::unique_ptr<uint8_t[]> _loss_floor;              // The least distance of a loss, due to the captures.
+
+    // Positions resolved at a distance known in advance: from the captures and promotions, or the deferred losses.
+    std::mutex _pending_mutex;
+    std::vector<std::vector<uint32_t>> _pending;
+    int _last_pending = -1;
+    std::atomic<bool> _failed{false};
+
+    static constexpr size_t ChunkSize = 1 << 14;
+
+    template<typename FnT>
+    void parallel_for(size_t count, const FnT& fn) {
+        for (size_t begin = 0; begin < count; begin += ChunkSize) {
+            const auto end = std::min(count, begin + ChunkSize);
+            _pool.submit([&fn, begin, end] { fn(begin, end); });
+        }
+        _pool.wait();
+    }
+
+    void add_pending(const std::vector<std::pair<int, uint32_t>>& pending) {
+        if (pending.empty()) return;
+        auto lock = std::lock_guard<std::mutex>{_pending_mutex};
+        for (const auto& [distance, index] : pending) {
+            if (distance > MaxDistance) {
+                _failed = true;
+                continue;
+            }
+            _pending[distance].push_back(index);
+            _last_pending = std::max(_last_pending, distance);
+        }
+    }
+
+    bool claim(size_t index, int distance) noexcept {
+        auto expected = uint8_t{0};
+        return _entries[index].compare_exchange_strong(expected, static_cast<uint8_t>(distance + 1), std::memory_order_relaxed);
+    }
+
+    void initialize(size_t begin, size_t end) {
+        auto pending = std::vector<std::pair<int, uint32_t>>{};
+        for (size_t index = begin; index < end; ++index) {
+            const auto player_to_move = static_cast<Player>(index % 2);
+            const auto ps = pieces_of(_layout, index);
+            if (!is_legal(ps, player_to_move)) {
+                _entries[index].store(IllegalEntry, std::memory_order_relaxed);
+                continue;
+            }
+
+            int move_count = 0;
+            int losing_moves = 0;
+            int loss_floor = 0;
+            int quickest_win = MaxDistance + 1;
+            foreach_move(ps, player_to_move, [&](const TbPieces& child, bool converted) {
+                ++move_count;
+                if (!converted) return;
+                const auto result = probe_pieces(child, other_player(player_to_move), _find_table);
+                if (!result) {
+                    _failed = true;
+                }
+                else if (result->wdl == TablebaseWdl::Loss) {
+                    quickest_win = std::min(quickest_win, result->plies + 1);
+                }
+                else if (result->wdl == TablebaseWdl::Win) {
+                    ++losing_moves;
+                    loss_floor = std::max(loss_floor, result->plies + 1);
+                }
+            });
+
+            _remaining[index].store(static_cast<uint8_t>(move_count - losing_moves), std::memory_order_relaxed);
+            _loss_floor[index] = static_cast<uint8_t>(std::min(loss_floor, MaxDistance + 1));
+            if (move_count == 0) {
+                if (is_in_check(ps, player_to_move)) pending.emplace_back(0, static_cast<uint32_t>(index));
+            }
+            else if (quickest_win <= MaxDistance) {
+                pending.emplace_back(quickest_win, static_cast<uint32_t>(index));
+            }
+            else if (losing_moves == move_count) {
+                pending.emplace_back(loss_floor, static_cast<uint32_t>(index));
+            }
+        }
+        add_pending(pending);
+    }
+
+    void propagate(uint32_t index, int distance, std::vector<uint32_t>& next, std::vector<std::pair<int, uint32_t>>& deferred) noexcept {
+        const auto player_to_move = static_cast<Player>(index % 2);
+        const auto parent_player = other_player(player_to_move);
+        const auto ps = pieces_of(_layout, index);
+
+        if (distance % 2 == 0) {
+            // Lost for the player to move: each parent wins by moving here.
+            foreach_unmove(ps, player_to_move, [&](const TbPieces& parent) {
+                const auto parent_index = index_of(parent, parent_player);
+                if (claim(parent_index, distance + 1)) next.push_back(static_cast<uint32_t>(parent_index));
+            });
+        }
+        else {
+            // Won for the player to move: one more move of each parent is refuted.
+            foreach_unmove(ps, player_to_move, [&](const TbPieces& parent) {
+                const auto parent_index = index_of(parent, parent_player);
+                if (_entries[parent_index].load(std::memory_order_relaxed) != 0) return;
+                if (_remaining[parent_index].fetch_sub(1, std::memory_order_relaxed) != 1) return;
+
+                const int loss_distance = std::max(distance + 1, static_cast<int>(_loss_floor[parent_index]));
+                if (loss_distance > distance + 1) {
+                    deferred.emplace_back(loss_distance, static_cast<uint32_t>(parent_index));
+                }
+                else if (claim(parent_index, loss_distance)) {
+                    next.push_back(static_cast<uint32_t>(parent_index));
+                }
+            });
+        }
+    }
+
+public:
+    TablebaseGenerator(const TbPieces& layout, TableFinder find_table, int thread_count) :
+        _layout{layout},
+        _size{table_size(layout.count)},
+        _find_table{std::move(find_table)},
+        _pool{thread_count},
+        _entries{std::make_unique<std::atomic<uint8_t>[]>(_size)},
+        _remaining{std::make_unique<std::atomic<uint8_t>[]>(_size)},
+        _loss_floor{std::make_unique<uint8_t[]>(_size)},
+        _pending(MaxDistance + 1)
+    {}
+
+    std::optional<std::vector<uint8_t>> run() {
+        parallel_for(_size, [this](size_t begin, size_t end) { initialize(begin, end); });
+        if (_failed) return std::nullopt;
+
+        auto resolved = std::vector<uint32_t>{};
+        auto next = std::vector<uint32_t>{};
+        for (int distance = 0; distance <= MaxDistance; ++distance) {
+            for (const auto index : _pending[distance]) {
+                if (claim(index, distance)) resolved.push_back(index);
+            }
+            _pending[distance] = {};
+            if (resolved.empty()) {
+                if (distance >= _last_pending) break;
+                continue;
+            }
+            if (distance == MaxDistance) return std::nullopt;
+
+            auto next_mutex = std::mutex{};
+            parallel_for(resolved.size(), [&](size_t begin, size_t end) {
+                auto local_next = std::vector<uint32_t>{};
+                auto deferred = std::vector<std::pair<int, uint32_t>>{};
+                for (size_t i = begin; i < end; ++i) {
+                    propagate(resolved[i], distance, local_next, deferred);
+                }
+                add_pending(deferred);
+                auto lock = std::lock_guard<std::mutex>{next_mutex};
+                next.insert(std::end(next), std::begin(local_next), std::end(local_next));
+            });
+            std::swap(resolved, next);
+            next.clear();
+        }
+        if (_failed) return std::nullopt;
+
+        auto values = std::vector<uint8_t>(_size);
+        for (size_t index = 0; index < _size; ++index) {
+            values[index] = _entries[index].load(std::memory_order_relaxed);
+        }
+        return values;
+    }
+};
+
+// Tells whether a castling move might still be legal, which the tables do not know of.
+bool may_castle(const GameState& s) noexcept {
+    const auto king_and_rook = [&s](Player p, bool forbidden, int rook_file) {
+        const int rank = is_white(p) ? 1 : 8;
+        return !forbidden && s(Coord{5, rank}) == make_square(p, Piece::King) &&
+            s(Coord{rook_file, rank}) == make_square(p, Piece::Rook);
+    };
+    return king_and_rook(Player::White, s.a1_castling_forbidden, 1) || king_and_rook(Player::White, s.h1_castling_forbidden, 8) ||
+        king_and_rook(Player::Black, s.a8_castling_forbidden, 1) || king_and_rook(Player::Black, s.h8_castling_forbidden, 8);
+}
+
+std::string table_path(const std::string& directory, std::string_view signature) {
+    auto path = directory;
+    if (!path.empty() && path.back() != '/') path += '/';
+    return path + tablebase_file_name(signature);
+}
+
+} // namespace
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+std::string tablebase_file_name(std::string_view signature) {
+    return std::string{signature} + ".rmtb";
+}
+
+const Tablebases::Table* Tablebases::find(std::string_view signature) const noexcept {
+    for (const auto& table : _tables) {
+        if (table.signature == signature) return &table;
+    }
+    return nullptr;
+}
+
+bool Tablebases::load(const std::string& directory, std::string_view signature) {
+    const auto layout = parse_signature(signature);
+    if (!layout) return false;
+    if (has(signature)) return true;
+
+    auto table = Table{};
+    table.signature = std::string{signature};
+    table.file = MappedFile{table_path(directory, signature)};
+    table.size = table_size(layout->count);
+    if (!table.file.is_open() || table.file.size() != TablebaseHeaderSize + table.size) return false;
+
+    const auto* data = reinterpret_cast<const uint8_t*>(table.file.data());
+    if (!std::equal(std::begin(TablebaseMagic), std::end(TablebaseMagic), data)) return false;
+    if (load_le<uint32_t>(data + 4) != TablebaseVersion) return false;
+    for (size_t i = 0; i < MaxTablebasePieces; ++i) {
+        const char c = i < signature.size() ? signature[i] : '\0';
+        if (static_cast<char>(data[SignatureOffset + i]) != c) return false;
+    }
+
+    table.values = data + TablebaseHeaderSize;
+    _tables.push_back(std::move(table));
+    return true;
+}
+
+int Tablebases::load_all(const std::string& directory) {
+    int loaded = 0;
+    for (const auto signature : TablebaseSignatures) {
+        if (load(directory, signature)) ++loaded;
+    }
+    return loaded;
+}
+
+bool Tablebases::generate(std::string_view signature, int thread_count) {
+    const auto layout = parse_signature(signature);
+    if (!layout) return false;
+    if (has(signature)) return true;
+
+    auto find_table = [this](std::string_view sig) -> const uint8_t* {
+        const auto* table = find(sig);
+        return table ? table->values : nullptr;
+    };
+    auto values = TablebaseGenerator{*layout, find_table, thread_count}.run();
+    if (!values) return false;
+
+    auto table = Table{};
+    table.signature = std::string{signature};
+    table.owned = std::move(*values);
+    table.values = table.owned.data();
+    table.size = table.owned.size();
+    _tables.push_back(std::move(table));
+    return true;
+}
+
+bool Tablebases::write(const std::string& directory, std::string_view signature) const {
+    const auto* table = find(signature);
+    if (!table) return false;
+
+    auto header = std::array<uint8_t, TablebaseHeaderSize>{};
+    std::copy(std::begin(TablebaseMagic), std::end(TablebaseMagic), header.data());
+    store_le(header.data() + 4, TablebaseVersion);
+    std::copy(signature.begin(), signature.end(), header.data() + SignatureOffset);
+
+    auto* file = std::fopen(table_path(directory, signature).c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(header.data(), 1, header.size(), file) == header.size();
+    ok = ok && std::fwrite(table->values, 1, table->size, file) == table->size;
+    return std::fclose(file) == 0 && ok;
+}
+
+std::optional<TablebaseStats> Tablebases::stats(std::string_view signature) const noexcept {
+    const auto* table = find(signature);
+    if (!table) return std::nullopt;
+
+    auto stats = TablebaseStats{};
+    for (size_t index = 0; index < table->size; ++index) {
+        const auto result = decode_entry(table->values[index]);
+        if (!result) continue;
+        ++stats.positions;
+        switch (result->wdl) {
+            case TablebaseWdl::Win: ++stats.wins; break;
+            case TablebaseWdl::Draw: ++stats.draws; break;
+            case TablebaseWdl::Loss: ++stats.losses; break;
+        }
+        stats.longest_mate = std::max(stats.longest_mate, result->plies);
+    }
+    return stats;
+}
+
+std::optional<TablebaseProbe> Tablebases::probe(const GameState& s) const noexcept {
+    if (_tables.empty()) return std::nullopt;
+
+    int piece_count = 0;
+    for (const auto tsq : s.squares) {
+        piece_count += ((tsq & 0x0F) != 0) + ((tsq >> 4) != 0);
+    }
+    if (piece_count > MaxTablebasePieces || may_castle(s)) return std::nullopt;
+
+    auto ps = TbPieces{};
+    s.foreach_piece([&ps](Coord c, Player p, Piece pc) {
+        assert(ps.count < MaxTablebasePieces);  // Counted above.
+        if (ps.count < MaxTablebasePieces) ps.pieces[ps.count++] = TbPiece{p, pc, square_index(c)};
+    });
+    return probe_pieces(ps, s.player_to_move, [this](std::string_view signature) -> const uint8_t* {
+        const auto* table = find(signature);
+        return table ? table->values : nullptr;
+    });
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
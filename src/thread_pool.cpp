@@ -0,0 +1,92 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#include "rookmole/thread_pool.h"
+#include "rookmole/trace.h"
+
+#include <algorithm>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+ThreadPool::ThreadPool(int thread_count)
+{
+    if (thread_count <= 0) thread_count = hardware_thread_count();
+    _workers.reserve(thread_count);
+    for (int i = 0; i < thread_count; ++i) {
+        _workers.emplace_back([this] { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        const auto lock = std::lock_guard{_mutex};
+        _quit = true;
+    }
+    _task_available.notify_all();
+    for (auto& worker : _workers) worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        const auto lock = std::lock_guard{_mutex};
+        _tasks.push_back(std::move(task));
+    }
+    _task_available.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    const auto trace_scope = TraceScope{"pool wait"};
+    auto lock = std::unique_lock{_mutex};
+    _all_done.wait(lock, [this] { return _tasks.empty() && _busy_count == 0; });
+}
+
+void ThreadPool::work()
+{
+    trace_thread_name("pool worker");
+    auto lock = std::unique_lock{_mutex};
+    for (;;) {
+        {
+            const auto trace_scope = TraceScope{"idle"};
+            _task_available.wait(lock, [this] { return _quit || !_tasks.empty(); });
+        }
+        if (_tasks.empty()) return;
+
+        auto task = std::move(_tasks.front());
+        _tasks.pop_front();
+        ++_busy_count;
+
+        lock.unlock();
+        {
+            const auto trace_scope = TraceScope{"task"};
+            task();
+        }
+        lock.lock();
+
+        --_busy_count;
+        if (_tasks.empty() && _busy_count == 0) _all_done.notify_all();
+    }
+}
+
+int hardware_thread_count() noexcept
+{
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
@@ -0,0 +1,183 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#include "rookmole/trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    int64_t start_nsec;
+    int64_t duration_nsec;  // Negative for an instant event.
+    int64_t arg;
+};
+
+// Written only by its thread: an event is filled in before the head passes it.
+class TraceBuffer {
+public:
+    static constexpr size_t Capacity = 1 << 16;
+
+    std::unique_ptr<TraceEvent[]> events = std::make_unique<TraceEvent[]>(Capacity);
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> tail{0};  // Events before it are dropped.
+    std::atomic<const char*> thread_name{nullptr};
+    int thread_id = 0;
+
+    void push(const TraceEvent& event) noexcept {
+        const auto h = head.load(std::memory_order_relaxed);
+        events[h % Capacity] = event;
+        head.store(h + 1, std::memory_order_release);
+    }
+};
+
+std::atomic<bool> tracing{false};
+
+// The buffers outlive their threads, so that the events of a finished thread pool can still be written. The ones of
+// the exited threads are released by `start_tracing`.
+std::mutex registry_mutex;
+std::vector<std::shared_ptr<TraceBuffer>> registry;
+int last_thread_id = 0;
+
+// Kept apart from the buffer, so that naming a thread does not allocate its buffer while not tracing.
+thread_local const char* local_thread_name = nullptr;
+thread_local std::shared_ptr<TraceBuffer> local_buffer_ptr;
+
+// Allocated on the first event recorded by the thread.
+TraceBuffer& local_buffer()
+{
+    if (!local_buffer_ptr) {
+        auto b = std::make_shared<TraceBuffer>();
+        b->thread_name.store(local_thread_name, std::memory_order_relaxed);
+        const auto lock = std::lock_guard{registry_mutex};
+        b->thread_id = ++last_thread_id;
+        registry.push_back(b);
+        local_buffer_ptr = std::move(b);
+    }
+    return *local_buffer_ptr;
+}
+
+void write_json_string(std::FILE* file, const char* text)
+{
+    std::fputc('"', file);
+    for (; *text; ++text) {
+        if (*text == '"' || *text == '\\') std::fputc('\\', file);
+        std::fputc(*text, file);
+    }
+    std::fputc('"', file);
+}
+
+} // namespace
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+void start_tracing() noexcept
+{
+    {
+        const auto lock = std::lock_guard{registry_mutex};
+        // Only the registry holds on to the buffers of the exited threads, whose events are dropped anyway.
+        registry.erase(std::remove_if(registry.begin(), registry.end(), [](const auto& buffer) {
+            return buffer.use_count() == 1;
+        }), registry.end());
+        for (const auto& buffer : registry) {
+            buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+        }
+    }
+    tracing.store(true, std::memory_order_release);
+}
+
+void stop_tracing() noexcept
+{
+    tracing.store(false, std::memory_order_release);
+}
+
+bool is_tracing() noexcept
+{
+    return tracing.load(std::memory_order_relaxed);
+}
+
+void record_trace_event(const char* name, int64_t start_nsec, int64_t duration_nsec, int64_t arg) noexcept
+{
+    local_buffer().push(TraceEvent{name, start_nsec, std::max<int64_t>(duration_nsec, 0), arg});
+}
+
+void record_trace_instant(const char* name, int64_t arg) noexcept
+{
+    local_buffer().push(TraceEvent{name, trace_clock_nsec(), -1, arg});
+}
+
+void set_trace_thread_name(const char* name) noexcept
+{
+    local_thread_name = name;
+    if (local_buffer_ptr) local_buffer_ptr->thread_name.store(name, std::memory_order_relaxed);
+}
+
+bool write_chrome_trace(const std::string& path)
+{
+    auto* file = std::fopen(path.c_str(), "w");
+    if (!file) return false;
+
+    std::fputs("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [", file);
+    bool first = true;
+    const auto separator = [&] {
+        std::fputs(first ? "\n" : ",\n", file);
+        first = false;
+    };
+
+    const auto lock = std::lock_guard{registry_mutex};
+    for (const auto& buffer : registry) {
+        const auto head = buffer->head.load(std::memory_order_acquire);
+        const auto tail = std::max(buffer->tail.load(std::memory_order_relaxed), head > TraceBuffer::Capacity ? head - TraceBuffer::Capacity : 0);
+        if (head == tail) continue;
+
+        if (const auto* thread_name = buffer->thread_name.load(std::memory_order_relaxed)) {
+            separator();
+            std::fprintf(file, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": ", buffer->thread_id);
+            write_json_string(file, thread_name);
+            std::fputs("}}", file);
+        }
+
+        for (auto i = tail; i < head; ++i) {
+            const auto& event = buffer->events[i % TraceBuffer::Capacity];
+            separator();
+            std::fputs("{\"name\": ", file);
+            write_json_string(file, event.name);
+            if (event.duration_nsec < 0) {
+                std::fprintf(file, ", \"ph\": \"i\", \"s\": \"t\", \"ts\": %.3f", static_cast<double>(event.start_nsec) / 1000.0);
+            }
+            else {
+                std::fprintf(file, ", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f", static_cast<double>(event.start_nsec) / 1000.0,
+                    static_cast<double>(event.duration_nsec) / 1000.0);
+            }
+            std::fprintf(file, ", \"pid\": 1, \"tid\": %d, \"args\": {\"arg\": %lld}}", buffer->thread_id,
+                static_cast<long long>(event.arg));
+        }
+    }
+
+    std::fputs("\n]}\n", file);
+    return std::fclose(file) == 0;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
@@ -0,0 +1,274 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#include "rookmole/training_data.h"
+#include "rookmole/alphabeta.h"
+#include "little_endian.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+namespace {
+
+constexpr char HeaderMagic[4] = {'R', 'M', 'T', 'D'};
+constexpr char FooterMagic[4] = {'R', 'M', 'T', 'I'};
+constexpr size_t HeaderSize = 32;
+constexpr size_t FooterSize = 24;  // Record count, block count, magic and padding; preceded by the block offsets.
+constexpr uint16_t CompressedFlag = 1;
+constexpr uint8_t NoSquare = 0xFF;
+
+// Control bytes: 0x80 | (n - 1) stands for n zero bytes, n - 1 for n literal bytes that follow.
+void compress_block(const uint8_t* block, size_t size, std::vector<uint8_t>& out) {
+    auto delta = std::vector<uint8_t>(size);
+    for (size_t i = 0; i < size; ++i) {
+        delta[i] = block[i] ^ (i >= TrainingRecordSize ? block[i - TrainingRecordSize] : 0);
+    }
+
+    out.clear();
+    size_t i = 0;
+    while (i < size) {
+        size_t run = 0;
+        while (i + run < size && run < 128 && delta[i + run] == 0) ++run;
+        if (run > 0) {
+            out.push_back(static_cast<uint8_t>(0x80 | (run - 1)));
+            i += run;
+            continue;
+        }
+
+        // A literal ends where at least two zeros begin.
+        size_t length = 0;
+        while (i + length < size && length < 128 &&
+            !(delta[i + length] == 0 && i + length + 1 < size && delta[i + length + 1] == 0)) ++length;
+        out.push_back(static_cast<uint8_t>(length - 1));
+        out.insert(out.end(), delta.begin() + i, delta.begin() + i + length);
+        i += length;
+    }
+}
+
+bool decompress_block(const uint8_t* in, size_t in_size, std::vector<uint8_t>& block) {
+    block.clear();
+    size_t i = 0;
+    while (i < in_size) {
+        const uint8_t control = in[i++];
+        const size_t length = (control & 0x7F) + 1;
+        if (control & 0x80) {
+            block.insert(block.end(), length, 0);
+        }
+        else {
+            if (i + length > in_size) return false;
+            block.insert(block.end(), in + i, in + i + length);
+            i += length;
+        }
+    }
+    if (block.size() % TrainingRecordSize != 0) return false;
+
+    for (size_t j = TrainingRecordSize; j < block.size(); ++j) {
+        block[j] ^= block[j - TrainingRecordSize];
+    }
+    return true;
+}
+
+} // namespace
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+int16_t to_training_score(int value) noexcept
+{
+    if (value >= MateValue - MaxMatePlies) return TrainingMateScore;
+    if (value <= -MateValue + MaxMatePlies) return -TrainingMateScore;
+    return static_cast<int16_t>(std::clamp(value, -TrainingMateScore + 1, TrainingMateScore - 1));
+}
+
+// Layout: 32 bytes of squares, castling flags (bits 0-3) with the en passant file (bits 4-7), the move count
+// (bits 0-6) with the player to move (bit 7), the score, the result and the best move as two square indices.
+PackedTrainingRecord pack(const TrainingRecord& record) noexcept
+{
+    auto packed = PackedTrainingRecord{};
+    const auto& s = record.state;
+    std::copy(std::begin(s.squares), std::end(s.squares), std::begin(packed));
+    packed[32] = static_cast<uint8_t>(s.a1_castling_forbidden | (s.h1_castling_forbidden << 1) |
+        (s.a8_castling_forbidden << 2) | (s.h8_castling_forbidden << 3) | (s.en_passant_file << 4));
+    packed[33] = static_cast<uint8_t>(s.move_count | (s.player_to_move << 7));
+    store_le(&packed[34], record.score);
+    packed[36] = static_cast<uint8_t>(record.result);
+    const bool has_move = is_valid(record.best_move.from) && is_valid(record.best_move.to);
+    packed[37] = has_move ? static_cast<uint8_t>(square_index(record.best_move.from)) : NoSquare;
+    packed[38] = has_move ? static_cast<uint8_t>(square_index(record.best_move.to)) : NoSquare;
+    return packed;
+}
+
+TrainingRecord unpack(const uint8_t* packed) noexcept
+{
+    auto record = TrainingRecord{};
+    auto& s = record.state;
+    std::copy(packed, packed + s.squares.size(), std::begin(s.squares));
+    s.a1_castling_forbidden = packed[32] & 1;
+    s.h1_castling_forbidden = (packed[32] >> 1) & 1;
+    s.a8_castling_forbidden = (packed[32] >> 2) & 1;
+    s.h8_castling_forbidden = (packed[32] >> 3) & 1;
+    s.en_passant_file = packed[32] >> 4;
+    s.move_count = packed[33] & 0x7F;
+    s.player_to_move = static_cast<Player>(packed[33] >> 7);
+    record.score = load_le<int16_t>(packed + 34);
+    record.result = static_cast<GameResult>(packed[36]);
+    if (packed[37] < 64 && packed[38] < 64) {
+        record.best_move = MoveCoord{coord_of(packed[37]), coord_of(packed[38])};
+    }
+    return record;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+TrainingDataWriter::TrainingDataWriter(const std::string& path, bool compress) :
+    _compress{compress}
+{
+    _file = std::fopen(path.c_str(), "wb");
+    if (!_file) return;
+
+    auto header = std::array<uint8_t, HeaderSize>{};
+    std::copy(std::begin(HeaderMagic), std::end(HeaderMagic), std::begin(header));
+    store_le(&header[4], TrainingDataVersion);
+    store_le(&header[6], compress ? CompressedFlag : uint16_t{0});
+    store_le(&header[8], static_cast<uint16_t>(TrainingRecordSize));
+    store_le(&header[12], TrainingBlockRecords);
+    write_bytes(header.data(), header.size());
+
+    _block.reserve(TrainingBlockRecords * TrainingRecordSize);
+}
+
+TrainingDataWriter::~TrainingDataWriter()
+{
+    close();
+}
+
+void TrainingDataWriter::write_bytes(const void* data, size_t size) noexcept
+{
+    if (std::fwrite(data, 1, size, _file) != size) _failed = true;
+    _offset += size;
+}
+
+void TrainingDataWriter::write(const TrainingRecord& record)
+{
+    assert(is_open());
+    const auto packed = pack(record);
+    _block.insert(_block.end(), packed.begin(), packed.end());
+    ++_record_count;
+    if (_block.size() == TrainingBlockRecords * TrainingRecordSize) flush_block();
+}
+
+void TrainingDataWriter::flush_block()
+{
+    if (_block.empty()) return;
+    if (_compress) {
+        compress_block(_block.data(), _block.size(), _compressed);
+        uint8_t size[4];
+        store_le(size, static_cast<uint32_t>(_compressed.size()));
+        _block_offsets.push_back(_offset);
+        write_bytes(size, sizeof(size));
+        write_bytes(_compressed.data(), _compressed.size());
+    }
+    else {
+        write_bytes(_block.data(), _block.size());
+    }
+    _block.clear();
+}
+
+bool TrainingDataWriter::close()
+{
+    if (!_file) return !_failed;
+
+    flush_block();
+    if (_compress) {
+        auto footer = std::vector<uint8_t>(8 * _block_offsets.size() + FooterSize);
+        for (size_t i = 0; i < _block_offsets.size(); ++i) store_le(&footer[8 * i], _block_offsets[i]);
+        auto* tail = footer.data() + 8 * _block_offsets.size();
+        store_le(tail, _record_count);
+        store_le(tail + 8, static_cast<uint64_t>(_block_offsets.size()));
+        std::copy(std::begin(FooterMagic), std::end(FooterMagic), tail + 16);
+        write_bytes(footer.data(), footer.size());
+    }
+
+    if (std::fclose(_file) != 0) _failed = true;
+    _file = nullptr;
+    return !_failed;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+TrainingDataReader::TrainingDataReader(const std::string& path) :
+    _file{path}
+{
+    if (!_file.is_open() || _file.size() < HeaderSize) return;
+
+    const auto* data = reinterpret_cast<const uint8_t*>(_file.data());
+    const size_t size = _file.size();
+    if (!std::equal(std::begin(HeaderMagic), std::end(HeaderMagic), data)) return;
+    if (load_le<uint16_t>(data + 4) != TrainingDataVersion) return;
+    if (load_le<uint16_t>(data + 8) != TrainingRecordSize) return;
+    if (load_le<uint32_t>(data + 12) != TrainingBlockRecords) return;
+    _compressed = load_le<uint16_t>(data + 6) & CompressedFlag;
+
+    if (_compressed) {
+        if (size < HeaderSize + FooterSize) return;
+        const auto* tail = data + size - FooterSize;
+        if (!std::equal(std::begin(FooterMagic), std::end(FooterMagic), tail + 16)) return;
+        _record_count = load_le<uint64_t>(tail);
+        _block_count = load_le<uint64_t>(tail + 8);
+        if (_block_count * 8 > size - HeaderSize - FooterSize) return;
+        if (_record_count > _block_count * TrainingBlockRecords) return;
+        _block_offsets = tail - 8 * _block_count;
+    }
+    else {
+        // A file that was not closed properly ends with a partial record, which is ignored.
+        _records = data + HeaderSize;
+        _record_count = (size - HeaderSize) / TrainingRecordSize;
+    }
+    _valid = true;
+}
+
+bool TrainingDataReader::load_block(uint64_t block_index)
+{
+    if (_cached_block == block_index) return true;
+    _cached_block = UINT64_MAX;
+
+    const auto* data = reinterpret_cast<const uint8_t*>(_file.data());
+    const uint64_t offset = load_le<uint64_t>(_block_offsets + 8 * block_index);
+    const uint64_t limit = static_cast<uint64_t>(_block_offsets - data);
+    if (offset + 4 > limit) return false;
+    const uint32_t compressed_size = load_le<uint32_t>(data + offset);
+    if (offset + 4 + compressed_size > limit) return false;
+    if (!decompress_block(data + offset + 4, compressed_size, _block)) return false;
+
+    _cached_block = block_index;
+    return true;
+}
+
+TrainingRecord TrainingDataReader::read(uint64_t index)
+{
+    assert(index < _record_count);
+    if (!_compressed) return unpack(_records + index * TrainingRecordSize);
+
+    const uint64_t block_index = index / TrainingBlockRecords;
+    const size_t offset = (index % TrainingBlockRecords) * TrainingRecordSize;
+    if (!load_block(block_index) || offset + TrainingRecordSize > _block.size()) return TrainingRecord{};
+    return unpack(_block.data() + offset);
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
@@ -0,0 +1,89 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#include "rookmole/zobrist.h"
+
+namespace rookmole {
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+namespace {
+
+// SplitMix64: https://prng.di.unimi.it/splitmix64.c
+constexpr uint64_t splitmix64(uint64_t& state) noexcept {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+struct ZobristTables {
+    uint64_t squares[16][64];       // Indexed by `Square` and square index. The `Empty` row stays zero.
+    uint64_t castling_forbidden[4]; // a1, h1, a8, h8
+    uint64_t en_passant_file[9];    // The "no en passant" entry stays zero.
+    uint64_t black_to_move;
+};
+
+constexpr ZobristTables make_zobrist_tables() noexcept {
+    auto tables = ZobristTables{};
+    uint64_t seed = 0x726F6F6B6D6F6C65ull;  // "rookmole"
+
+    for (int sq = 1; sq < 16; ++sq) {
+        for (int i = 0; i < 64; ++i) {
+            tables.squares[sq][i] = splitmix64(seed);
+        }
+    }
+    for (auto& key : tables.castling_forbidden) key = splitmix64(seed);
+    for (int file = 1; file <= 8; ++file) tables.en_passant_file[file] = splitmix64(seed);
+    tables.black_to_move = splitmix64(seed);
+
+    return tables;
+}
+
+constexpr ZobristTables zobrist_tables = make_zobrist_tables();
+
+} // namespace
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+uint64_t zobrist_key(const GameState& s) noexcept
+{
+    uint64_t key = 0;
+
+    for (int j = 0; j < static_cast<int>(s.squares.size()); ++j) {
+        const auto tsq = s.squares[j];
+        if (tsq == 0) continue;
+        key ^= zobrist_tables.squares[tsq & 0x0F][2 * j] ^ zobrist_tables.squares[tsq >> 4][2 * j + 1];
+    }
+
+    if (s.a1_castling_forbidden) key ^= zobrist_tables.castling_forbidden[0];
+    if (s.h1_castling_forbidden) key ^= zobrist_tables.castling_forbidden[1];
+    if (s.a8_castling_forbidden) key ^= zobrist_tables.castling_forbidden[2];
+    if (s.h8_castling_forbidden) key ^= zobrist_tables.castling_forbidden[3];
+    key ^= zobrist_tables.en_passant_file[s.en_passant_file];
+    if (is_black(s.player_to_move)) key ^= zobrist_tables.black_to_move;
+
+    return key;
+}
+
+uint64_t zobrist_pawn_key(Bitboard white_pawns, Bitboard black_pawns) noexcept
+{
+    uint64_t key = 0;
+    foreach_bit(white_pawns, [&key](int i) { key ^= zobrist_tables.squares[Square::WhitePawn][i]; });
+    foreach_bit(black_pawns, [&key](int i) { key ^= zobrist_tables.squares[Square::BlackPawn][i]; });
+    return key;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+} // namespace rookmole
@@ -33,14 +33,18 @@ int main(int argc, char* argv[])
     auto human_player = Player::White;
     std::cout << "You play as: " << human_player << std::endl;
 
-    auto s0 = make_start_state();
-    auto lm0 = get_legal_moves(s0);
-    auto n = GameNode{std::move(s0), std::move(lm0), false};
+    // An optional opening book, e.g. built with rookmole.book.
+    const auto book = argc > 1 ? OpeningBook{argv[1]} : OpeningBook{};
+    if (argc > 1 && !book.is_open()) {
+        std::cout << "Cannot open the opening book: " << argv[1] << std::endl;
+    }
+
+    auto n = make_start_node();
 
     while (true)
     {
         std::cout << n.state << std::endl;
-        std::cout << "Possible moves: " << n.next_moves << std::endl;
+        std::cout << "Possible moves: " << n.next_moves() << std::endl;
 
         std::optional<MoveCoord> move_to_make_opt{};
 
@@ -54,7 +58,7 @@ int main(int argc, char* argv[])
                     const auto user_move = make_move_coord(user_move_text);
 
                     bool is_move_legal = false;
-                    for (const auto legal_move : n.next_moves) {
+                    for (const auto legal_move : n.next_moves()) {
                         if (user_move == legal_move) {
                             is_move_legal = true;
                             break;
@@ -62,7 +66,7 @@ int main(int argc, char* argv[])
                     }
 
                     if (!is_move_legal) {
-                        std::cout << "This move is illegal. Valid moves are:\n" << n.next_moves << std::endl;
+                        std::cout << "This move is illegal. Valid moves are:\n" << n.next_moves() << std::endl;
                         continue;
                     }
 
@@ -71,15 +75,22 @@ int main(int argc, char* argv[])
                 }
             }
             else {
-                std::cout << "Thinking..." << std::endl;
-                const auto search_result = alphabeta(n, 6);
-                move_to_make_opt = search_result.move;
+                const auto book_move = book.pick_move(n.state, (uint64_t)rand() << 32 | (uint64_t)rand());
+                if (book_move && is_move_coord_legal(n.next_moves(), *book_move)) {
+                    std::cout << "Book move." << std::endl;
+                    move_to_make_opt = *book_move;
+                }
+                else {
+                    std::cout << "Thinking..." << std::endl;
+                    const auto search_result = alphabeta(n, 6);
+                    move_to_make_opt = search_result.move;
+                }
             }
         }
 
         if (!move_to_make_opt) {
             std::cout << "No moves to make." << std::endl;
-            if (n.king_in_check) {
+            if (n.king_in_check()) {
                 std::cout << "The winner is " << other_player(n.state.player_to_move) << "!" << std::endl;
             }
             else {
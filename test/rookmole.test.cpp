@@ -10,15 +10,22 @@
    ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
 */
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
 #include <limits>
+#include <mutex>
+#include <thread>
 #include <type_traits>
 
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
 #include <rookmole/rookmole.h>
+#include "../bench/alloc_counter.h"
 using namespace rookmole;
 
 TEST_CASE("openings", "[get_legal_moves]") {
@@ -58,6 +65,20 @@ TEMPLATE_TEST_CASE("reveal_check", "[get_legal_moves]", (std::integral_constant<
     REQUIRE(get_legal_moves(s) == make_move_coord_vec("d3:e3 d3:e2 d3:d2 d3:c2 d3:c3 d3:c4", reverse));
 }
 
+TEMPLATE_TEST_CASE("pawn_attacks", "[get_legal_moves]", (std::integral_constant<bool, false>), (std::integral_constant<bool, true>)) {
+    constexpr bool reverse = TestType::value;
+    const auto me = !reverse ? Player::White : Player::Black;
+    // Pawn attacks do not depend on who is to move.
+    for (const auto player_to_move : {Player::White, Player::Black}) {
+        auto s = make_custom_state("Ke1 pd4 | Ke8 pg5", player_to_move, reverse);
+        REQUIRE(is_attacked_by(me, make_coord<reverse>("c5"), s));
+        REQUIRE(is_attacked_by(me, make_coord<reverse>("e5"), s));
+        REQUIRE(!is_attacked_by(me, make_coord<reverse>("e3"), s));
+        REQUIRE(is_attacked_by(other_player(me), make_coord<reverse>("h4"), s));
+        REQUIRE(!is_attacked_by(other_player(me), make_coord<reverse>("h6"), s));
+    }
+}
+
 TEMPLATE_TEST_CASE("stalemate", "[get_legal_moves]", (std::integral_constant<bool, false>), (std::integral_constant<bool, true>)) {
     constexpr bool reverse = TestType::value;
     auto s = make_custom_state("Kb1 | pc2 Bh8 Nb4 Ne2", Player::White, reverse);
@@ -102,6 +123,75 @@ TEMPLATE_TEST_CASE("castling_blocked", "[get_legal_moves]", (std::integral_const
     }
 }
 
+TEST_CASE("move_gen_modes", "[get_legal_moves]") {
+    const auto to_vec = [](const MoveList& moves) {
+        auto v = std::vector<uint16_t>{};
+        for (const auto m : moves) v.push_back(m.bits());
+        std::sort(v.begin(), v.end());
+        return v;
+    };
+
+    for (const auto fen : {
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "rnbqkbnr/ppp2ppp/8/3pp3/4P3/5Q2/PPPP1PPP/RNB1KBNR w KQkq d6 0 3",
+            "4k3/8/8/2pP4/1K6/8/8/8 w - c6 0 1",        // Checked by the pawn captured en passant.
+            "4k3/8/8/8/1b6/8/8/r3K3 w - - 0 1",         // Double check.
+            "rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3",  // Mate.
+            "3k4/3r4/8/8/8/8/3P4/R2K3R w - - 0 1"}) {
+        const auto s = *parse_fen(fen);
+        auto legal = MoveList{}, captures = MoveList{}, quiets = MoveList{}, evasions = MoveList{}, quiet_checks = MoveList{};
+        get_legal_moves<MoveGenMode::Legal>(s, legal);
+        get_legal_moves<MoveGenMode::Captures>(s, captures);
+        get_legal_moves<MoveGenMode::Quiets>(s, quiets);
+        get_legal_moves<MoveGenMode::QuietChecks>(s, quiet_checks);
+
+        auto all = to_vec(captures);
+        for (const auto m : quiets) all.push_back(m.bits());
+        std::sort(all.begin(), all.end());
+        REQUIRE(all == to_vec(legal));
+        REQUIRE(captures.size() + quiets.size() == legal.size());
+        for (const auto m : captures) REQUIRE((m.is_capture() || m.is_promotion()));
+
+        auto expected_checks = std::vector<uint16_t>{};
+        for (const auto m : quiets) {
+            const auto child = make_move(s, m);
+            if (is_king_in_check(child.state)) expected_checks.push_back(m.bits());
+        }
+        std::sort(expected_checks.begin(), expected_checks.end());
+        REQUIRE(to_vec(quiet_checks) == expected_checks);
+
+        if (is_king_in_check(s)) {
+            get_legal_moves<MoveGenMode::Evasions>(s, evasions);
+            REQUIRE(to_vec(evasions) == to_vec(legal));
+        }
+    }
+}
+
+TEST_CASE("geometry_tables", "[bitboard]") {
+    const auto sq = [](std::string_view text) { return square_index(Coord{text}); };
+    const auto bits = [](std::string_view text) {
+        Bitboard b = 0;
+        for (size_t i = 0; i + 2 <= text.size(); i += 3) b |= bit(Coord{text.substr(i, 2)});
+        return b;
+    };
+
+    REQUIRE(knight_attacks(sq("a1")) == bits("b3 c2"));
+    REQUIRE(king_attacks(sq("h8")) == bits("g8 g7 h7"));
+    REQUIRE(pawn_attacks_from(Player::White, sq("a2")) == bits("b3"));
+    REQUIRE(pawn_attacks_from(Player::Black, sq("e7")) == bits("d6 f6"));
+    REQUIRE(ray_mask(NorthWest, sq("e4")) == bits("d5 c6 b7 a8"));
+    REQUIRE(between_mask(sq("a1"), sq("d4")) == bits("b2 c3"));
+    REQUIRE(between_mask(sq("d4"), sq("a1")) == bits("b2 c3"));
+    REQUIRE(between_mask(sq("e1"), sq("e2")) == 0);
+    REQUIRE(between_mask(sq("a1"), sq("b3")) == 0);
+    REQUIRE(line_mask(sq("b2"), sq("b7")) == file_bitboard(2));
+    REQUIRE(line_mask(sq("c1"), sq("a3")) == bits("a3 b2 c1"));
+    REQUIRE(line_mask(sq("a1"), sq("b3")) == 0);
+    REQUIRE(rook_attacks(sq("d4"), bits("d6 b4 d1")) == bits("d5 d6 c4 b4 e4 f4 g4 h4 d3 d2 d1"));
+    REQUIRE(bishop_attacks(sq("d4"), bits("f6 b2")) == bits("e5 f6 c5 b6 a7 e3 f2 g1 c3 b2"));
+}
+
 TEMPLATE_TEST_CASE("en_passant_capture", "[make_move]", (std::integral_constant<bool, false>), (std::integral_constant<bool, true>)) {
     constexpr bool reverse = TestType::value;
     auto s0 = make_custom_state("pf5 | pg5 ph7", Player::White, reverse);
@@ -111,18 +201,41 @@ TEMPLATE_TEST_CASE("en_passant_capture", "[make_move]", (std::integral_constant<
     REQUIRE(n1.state.move_count == (is_white(s0.player_to_move) ? 0 : 1));
     REQUIRE(piece_of(n1.state(make_coord<reverse>("g6"))) == Piece::Pawn);
     REQUIRE(is_empty(n1.state(make_coord<reverse>("g5"))));
-    REQUIRE(n1.next_moves == make_move_coord_vec("h7:g6 h7:h6 h7:h5", reverse));
-    REQUIRE(!n1.king_in_check);
+    REQUIRE(n1.next_moves() == make_move_coord_vec("h7:g6 h7:h6 h7:h5", reverse));
+    REQUIRE(!n1.king_in_check());
 
     auto n2 = make_move(n1.state, make_move_coord<reverse>("h7:h5"));
     REQUIRE(n2.state.move_count == (is_white(s0.player_to_move) ? 1 : 1));
-    REQUIRE(n2.next_moves == make_move_coord_vec("g6:g7", reverse));
-    REQUIRE(!n2.king_in_check);
+    REQUIRE(n2.next_moves() == make_move_coord_vec("g6:g7", reverse));
+    REQUIRE(!n2.king_in_check());
+}
+
+TEST_CASE("fools_mate", "[make_move]") {
+    auto n = make_start_node();
+    for (const auto move : make_move_coord_vec("f2:f3 e7:e5 g2:g4")) {
+        n = make_move(n.state, move);
+        REQUIRE(!n.king_in_check());
+        REQUIRE(n.has_any_legal_move());
+    }
+
+    n = make_move(n.state, make_move_coord("d8:h4"));
+    REQUIRE(n.king_in_check());
+    REQUIRE(!n.has_any_legal_move());
+    REQUIRE(n.next_moves().empty());
+    REQUIRE(is_terminal(n));
+}
+
+TEMPLATE_TEST_CASE("lazy_stalemate", "[make_move]", (std::integral_constant<bool, false>), (std::integral_constant<bool, true>)) {
+    constexpr bool reverse = TestType::value;
+    const auto n = GameNode{make_custom_state("Ka1 | Qb3 Kc3", Player::White, reverse)};
+    REQUIRE(!n.has_any_legal_move());
+    REQUIRE(!n.king_in_check());
+    REQUIRE(is_terminal(n));
 }
 
 TEST_CASE("italian_game", "[make_move]") {
     const auto s0 = make_start_state();
-    auto n = GameNode{s0, get_legal_moves(s0), false};
+    auto n = GameNode{s0};
 
     auto moves = make_move_coord_vec("e2:e4 e7:e5 g1:f3 b8:c6 f1:c4 g8:f6 e1:g1 f8:c5 d2:d3 e8:g8");
     for (const auto move : moves) {
@@ -130,18 +243,819 @@ TEST_CASE("italian_game", "[make_move]") {
     }
 }
 
+TEST_CASE("packed_moves", "[make_move]") {
+    const auto castling = Move{Coord{"e1"}, Coord{"g1"}, MoveFlag::KingCastling};
+    REQUIRE(castling.from() == 4);
+    REQUIRE(castling.to() == 6);
+    REQUIRE(castling.is_castling());
+    REQUIRE(!castling.is_capture());
+    REQUIRE(to_move_coord(castling) == make_move_coord("e1:g1"));
+
+    const auto s = *parse_fen("r3k2r/1P6/8/3pP3/8/8/7P/R3K2R w KQkq d6 0 1");
+    REQUIRE(to_move(s, make_move_coord("e1:g1")) == castling);
+    REQUIRE(to_move(s, make_move_coord("e1:c1")).flag() == MoveFlag::QueenCastling);
+    REQUIRE(to_move(s, make_move_coord("e5:d6")).flag() == MoveFlag::EnPassant);
+    REQUIRE(to_move(s, make_move_coord("b7:b8")).flag() == MoveFlag::Promotion);
+    REQUIRE(to_move(s, make_move_coord("b7:a8")).flag() == MoveFlag::PromotionCapture);
+    REQUIRE(to_move(s, make_move_coord("h2:h4")).flag() == MoveFlag::DoublePush);
+    REQUIRE(to_move(s, make_move_coord("a1:a8")).flag() == MoveFlag::Capture);
+    REQUIRE(to_move(s, make_move_coord("a1:a2")).flag() == MoveFlag::Quiet);
+    REQUIRE(to_move(s, make_move_coord("e5:d6")).is_capture());
+    REQUIRE(to_move(s, make_move_coord("b7:a8")).is_capture());
+
+    // The conversion to `MoveCoord` and back is lossless, and both kinds of moves are made alike.
+    auto moves = MoveList{};
+    for (const auto fen : BenchmarkFens) {
+        const auto state = *parse_fen(fen);
+        get_legal_moves(state, moves);
+        REQUIRE(moves.size() == get_legal_moves(state).size());
+        for (const auto m : moves) {
+            REQUIRE(to_move(state, to_move_coord(m)) == m);
+            const auto made = make_move(state, m).state;
+            const auto made_from_coords = make_move(state, to_move_coord(m)).state;
+            REQUIRE(std::memcmp(&made, &made_from_coords, sizeof(GameState)) == 0);
+        }
+    }
+}
+
+TEST_CASE("perft", "[make_move]") {
+    REQUIRE(perft(make_start_state(), 1) == 20);
+    REQUIRE(perft(make_start_state(), 2) == 400);
+    REQUIRE(perft(make_start_state(), 3) == 8902);
+    REQUIRE(perft(make_start_state(), 4) == 197281);
+
+    // Castling through, out of and into attacked squares, and castling rights lost to captured rooks.
+    const auto kiwipete = *parse_fen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    REQUIRE(perft(kiwipete, 1) == 48);
+    REQUIRE(perft(kiwipete, 2) == 2039);
+    REQUIRE(perft(kiwipete, 3) == 97862);
+
+    // The same with the colors swapped, for the move generation specialized for black.
+    const auto kiwipete_black = *parse_fen("r3k2r/pppbbppp/2n2q1P/1P2p3/3pn3/BN2PNP1/P1PPQPB1/R3K2R b KQkq - 0 1");
+    REQUIRE(perft(kiwipete_black, 1) == 48);
+    REQUIRE(perft(kiwipete_black, 2) == 2039);
+    REQUIRE(perft(kiwipete_black, 3) == 97862);
+    auto moves = MoveList{};
+    get_legal_moves<Player::Black>(kiwipete_black, moves);
+    REQUIRE(moves.size() == 48);
+
+    // En passant captures uncovering the king along the rank.
+    const auto pins = *parse_fen("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+    REQUIRE(perft(pins, 1) == 14);
+    REQUIRE(perft(pins, 2) == 191);
+    REQUIRE(perft(pins, 3) == 2812);
+    REQUIRE(perft(pins, 4) == 43238);
+}
+
+TEST_CASE("see", "[see]") {
+    const auto see_of = [](std::string_view fen, std::string_view move) {
+        const auto s = *parse_fen(fen);
+        return see(s, to_move(s, make_move_coord(move)));
+    };
+
+    REQUIRE(see_of("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1:e5") == 100);
+    REQUIRE(see_of("4k3/8/3p4/4p3/8/8/8/4QK2 w - - 0 1", "e1:e5") == 100 - 800);
+    REQUIRE(see_of("4k3/4r3/8/4p3/8/8/4R3/6K1 w - - 0 1", "e2:e5") == 100 - 500);
+    REQUIRE(see_of("4k3/4r3/8/4p3/8/8/4R3/4R1K1 w - - 0 1", "e2:e5") == 100);  // The rook behind joins in.
+    REQUIRE(see_of("4k3/8/2b5/8/4p3/8/6B1/K6Q w - - 0 1", "g2:e4") == 100);      // So does the queen behind the bishop.
+    REQUIRE(see_of("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5:d6") == 100);
+    REQUIRE(see_of("3r2k1/2P5/8/8/8/8/8/4K3 w - - 0 1", "c7:d8") == 500 + 700);
+    REQUIRE(see_of("3r2k1/2P5/8/8/8/8/8/4K3 w - - 0 1", "c7:c8") == 700 - 800);
+    REQUIRE(see_of("8/8/4k3/3p4/4P3/8/8/4K3 w - - 0 1", "e4:d5") == 0);
+    REQUIRE(see_of("8/8/4k3/3p4/4P3/8/8/3QK3 w - - 0 1", "e4:d5") == 100);    // The king may not recapture.
+    REQUIRE(see_of("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", "g1:f3") == 0);
+
+    for (const auto fen : BenchmarkFens) {
+        const auto s = *parse_fen(fen);
+        auto moves = MoveList{};
+        get_legal_moves(s, moves);
+        for (const auto m : moves) {
+            const int value = see(s, m);
+            REQUIRE(value <= capture_gain(s, m));
+            for (const int threshold : {-800, -100, 0, 1, 100, 300}) {
+                REQUIRE(see_ge(s, m, threshold) == (value >= threshold));
+            }
+        }
+    }
+}
+
+TEST_CASE("evaluate_batch", "[evaluation]") {
+    auto states = std::vector<GameState>{make_start_state()};
+    for (int depth = 0; depth < 2; ++depth) {
+        const size_t level_size = states.size();
+        for (size_t i = 0; i < level_size; ++i) {
+            for (const auto m : get_legal_moves(states[i])) {
+                states.push_back(make_move(states[i], m).state);
+            }
+        }
+    }
+    states.push_back(make_custom_state("Qa1 Qb2 Qc3 Qd4 Qe5 Qf6 Qg7 Qh8 Qa8 pb7 | Kh1 ph2", Player::White, false));
+    REQUIRE(states.size() % 16 != 0);
+
+    for (const auto eval_player : {Player::White, Player::Black}) {
+        auto scores = std::vector<int>(states.size());
+        evaluate_batch(eval_player, states.data(), scores.data(), states.size());
+        for (size_t i = 0; i < states.size(); ++i) {
+            REQUIRE(scores[i] == evaluate_material(eval_player, states[i]));
+        }
+    }
+}
+
+TEST_CASE("transposition", "[zobrist]") {
+    const auto s0 = make_start_state();
+    auto s1 = s0;
+    for (const auto move : make_move_coord_vec("g1:f3 g8:f6 b1:c3")) s1 = make_move(s1, move).state;
+    auto s2 = s0;
+    for (const auto move : make_move_coord_vec("b1:c3 g8:f6 g1:f3")) s2 = make_move(s2, move).state;
+    REQUIRE(zobrist_key(s1) == zobrist_key(s2));
+    REQUIRE(zobrist_key(s0) != zobrist_key(s1));
+
+    auto s3 = s1;
+    s3.h1_castling_forbidden = true;
+    REQUIRE(zobrist_key(s3) != zobrist_key(s1));
+
+    const auto s4 = make_move(s0, make_move_coord("e2:e4")).state;
+    auto s5 = s4;
+    s5.en_passant_file = 0;
+    REQUIRE(zobrist_key(s4) != zobrist_key(s5));
+
+    const auto bbs0 = make_bitboards(s0);
+    const auto bbs1 = make_bitboards(s1);
+    REQUIRE(zobrist_pawn_key(bbs0.of(Player::White, Piece::Pawn), bbs0.of(Player::Black, Piece::Pawn)) ==
+            zobrist_pawn_key(bbs1.of(Player::White, Piece::Pawn), bbs1.of(Player::Black, Piece::Pawn)));
+}
+
+TEMPLATE_TEST_CASE("doubled_isolated_passed", "[evaluation]", (std::integral_constant<bool, false>), (std::integral_constant<bool, true>)) {
+    constexpr bool reverse = TestType::value;
+    const auto s = make_custom_state("Ke1 pa2 pa3 | Ke8 ph7", Player::White, reverse);
+    REQUIRE(evaluate_pawn_structure(reverse ? Player::Black : Player::White, s) == -17);
+}
+
+TEMPLATE_TEST_CASE("backward", "[evaluation]", (std::integral_constant<bool, false>), (std::integral_constant<bool, true>)) {
+    constexpr bool reverse = TestType::value;
+    const auto s = make_custom_state("Ke1 pb2 pc3 | Ke8 pa4", Player::White, reverse);
+    REQUIRE(evaluate_pawn_structure(reverse ? Player::Black : Player::White, s) == 15);
+
+    const auto stats_before = pawn_hash_stats();
+    REQUIRE(evaluate_pawn_structure(reverse ? Player::White : Player::Black, s) == -15);
+    const auto stats = pawn_hash_stats() - stats_before;
+    REQUIRE(stats.probes == 1);
+    REQUIRE(stats.hits == 1);
+}
+
+TEST_CASE("mobility", "[evaluation]") {
+    auto make_node = [](GameState s) { return GameNode{s}; };
+
+    const auto centre = make_node(make_custom_state("Kh1 Nd4 | Ka8", Player::White, false));
+    const auto corner = make_node(make_custom_state("Kh1 Na1 | Ka8", Player::White, false));
+    REQUIRE(evaluate_hardcode(Player::White, centre) - evaluate_hardcode(Player::White, corner) == 4 * (8 - 2));
+
+    for (const auto text : {"Kd3 pd4 Bc4 | Nc5 Rd7 Ke8", "Ke1 Qd1 Ra1 pe4 pf2 | Ke8 Qd8 Nc6 pe5 pd6", "Kg1 Rf1 | Kg8 Qb6"}) {
+        for (const auto player_to_move : {Player::White, Player::Black}) {
+            const auto n = make_node(make_custom_state(text, player_to_move, false));
+            const auto n_reversed = make_node(make_custom_state(text, player_to_move, true));
+            REQUIRE(evaluate_hardcode(Player::White, n) == evaluate_hardcode(Player::Black, n_reversed));
+            REQUIRE(evaluate_hardcode(Player::Black, n) == evaluate_hardcode(Player::White, n_reversed));
+        }
+    }
+}
+
+TEST_CASE("eval_cache", "[evaluation]") {
+    auto nodes = std::vector<GameNode>{make_start_node()};
+    for (const auto m : nodes[0].next_moves()) {
+        nodes.push_back(make_move(nodes[0].state, m));
+    }
+
+    configure_eval_cache(DefaultEvalCacheSizeLog2);
+    auto stats_before = eval_cache_stats();
+    for (int pass = 0; pass < 2; ++pass) {
+        for (const auto& n : nodes) {
+            for (const auto eval_player : {Player::White, Player::Black}) {
+                REQUIRE(evaluate_cached(eval_player, n) == evaluate_hardcode(eval_player, n));
+            }
+        }
+    }
+    auto stats = eval_cache_stats() - stats_before;
+    REQUIRE(stats.probes == 4 * nodes.size());
+    REQUIRE(stats.hits == 2 * nodes.size());
+
+    configure_eval_cache(0);
+    stats_before = eval_cache_stats();
+    REQUIRE(evaluate_cached(Player::White, nodes[0]) == evaluate_hardcode(Player::White, nodes[0]));
+    REQUIRE((eval_cache_stats() - stats_before).probes == 0);
+
+    // A tiny cache shared by several threads keeps overwriting the same entries.
+    configure_eval_cache(4);
+    auto mismatches = std::atomic<int>{0};
+    auto threads = std::vector<std::thread>{};
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&nodes, &mismatches, t] {
+            for (int pass = 0; pass < 50; ++pass) {
+                for (size_t i = 0; i < nodes.size(); ++i) {
+                    const auto& n = nodes[(i + t) % nodes.size()];
+                    if (evaluate_cached(Player::White, n) != evaluate_hardcode(Player::White, n)) ++mismatches;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    REQUIRE(mismatches == 0);
+
+    configure_eval_cache(DefaultEvalCacheSizeLog2);
+}
+
+TEST_CASE("uci_moves", "[notation]") {
+    auto s = make_start_state();
+    REQUIRE(to_uci_move(s, make_move_coord("g1:f3")) == "g1f3");
+    REQUIRE(parse_uci_move(s, "e2e4") == make_move_coord("e2:e4"));
+    REQUIRE(!parse_uci_move(s, "e2e5"));
+    REQUIRE(!parse_uci_move(s, "e2e4q"));
+    REQUIRE(!parse_uci_move(s, "z9e4"));
+
+    s = make_custom_state("Ke1 Rh1 pb7 | Ke8", Player::White, false);
+    s.a1_castling_forbidden = true;
+    REQUIRE(parse_uci_move(s, "e1g1") == make_move_coord("e1:g1"));
+    REQUIRE(to_uci_move(s, make_move_coord("b7:b8")) == "b7b8q");
+    REQUIRE(parse_uci_move(s, "b7b8q") == make_move_coord("b7:b8"));
+    REQUIRE(!parse_uci_move(s, "b7b8n"));
+    REQUIRE(to_uci_line(s, make_move_coord_vec("b7:b8 e8:e7 b8:b4")) == "b7b8q e8e7 b8b4");
+}
+
+TEST_CASE("san_moves", "[notation]") {
+    auto s = make_start_state();
+    REQUIRE(to_san_move(s, make_move_coord("g1:f3")) == "Nf3");
+    REQUIRE(parse_san_move(s, "Nf3") == make_move_coord("g1:f3"));
+    REQUIRE(parse_san_move(s, "e4") == make_move_coord("e2:e4"));
+    REQUIRE(parse_san_move(s, "e3!?") == make_move_coord("e2:e3"));
+    REQUIRE(!parse_san_move(s, "e5"));
+    REQUIRE(!parse_san_move(s, "Nd2"));
+    REQUIRE(!parse_san_move(s, "Qh5"));
+
+    s = make_custom_state("Ke1 Ra1 Rh1 Nb1 Nf3 pd4 pb7 | Ke8 pe5", Player::White, false);
+    REQUIRE(to_san_move(s, make_move_coord("b1:d2")) == "Nbd2");
+    REQUIRE(parse_san_move(s, "Nbd2") == make_move_coord("b1:d2"));
+    REQUIRE(!parse_san_move(s, "Nd2"));
+    REQUIRE(to_san_move(s, make_move_coord("d4:e5")) == "dxe5");
+    REQUIRE(parse_san_move(s, "dxe5") == make_move_coord("d4:e5"));
+    REQUIRE(to_san_move(s, make_move_coord("e1:g1")) == "O-O");
+    REQUIRE(parse_san_move(s, "0-0") == make_move_coord("e1:g1"));
+    REQUIRE(!parse_san_move(s, "O-O-O"));
+    REQUIRE(to_san_move(s, make_move_coord("b7:b8")) == "b8=Q+");
+    REQUIRE(parse_san_move(s, "b8=Q+") == make_move_coord("b7:b8"));
+    REQUIRE(parse_san_move(s, "b8Q") == make_move_coord("b7:b8"));
+    REQUIRE(!parse_san_move(s, "b8=N"));
+
+    // A pinned knight does not make the move of the other one ambiguous.
+    s = make_custom_state("Ke1 Nc3 Ng1 | Ke8 Bb4", Player::White, false);
+    REQUIRE(to_san_move(s, make_move_coord("g1:e2")) == "Ne2");
+    REQUIRE(parse_san_move(s, "Ne2") == make_move_coord("g1:e2"));
+
+    auto n = make_start_node();
+    for (const auto san : {"f3", "e5", "g4", "Qh4#"}) {
+        const auto m = parse_san_move(n.state, san);
+        REQUIRE(m);
+        REQUIRE(to_san_move(n.state, *m) == san);
+        n = make_move(n.state, *m);
+    }
+}
+
+TEST_CASE("fen", "[notation]") {
+    auto s = make_start_state();
+    REQUIRE(to_fen(s) == "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    const auto start = parse_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    REQUIRE(start);
+    REQUIRE(std::memcmp(&*start, &s, sizeof(GameState)) == 0);
+
+    s = make_move(s, make_move_coord("e2:e4")).state;
+    REQUIRE(to_fen(s) == "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1");
+    s = make_move(s, make_move_coord("e7:e5")).state;
+    s = make_move(s, make_move_coord("e1:e2")).state;
+    REQUIRE(to_fen(s) == "rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPPKPPP/RNBQ1BNR b kq - 0 2");
+
+    const auto kiwipete = parse_fen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w Qk - 3 42");
+    REQUIRE(kiwipete);
+    REQUIRE(kiwipete->a1_castling_forbidden == false);
+    REQUIRE(kiwipete->h1_castling_forbidden == true);
+    REQUIRE(kiwipete->a8_castling_forbidden == true);
+    REQUIRE(kiwipete->h8_castling_forbidden == false);
+    REQUIRE(kiwipete->move_count == 41);
+    REQUIRE((*kiwipete)(Coord{"e5"}) == Square::WhiteKnight);
+    REQUIRE((*kiwipete)(Coord{"a8"}) == Square::BlackRook);
+    REQUIRE(to_fen(*kiwipete) == "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w Qk - 0 42");
+
+    const auto record = parse_epd("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - bm Ra8#; am h3 Kf1; id \"mate; in one\";");
+    REQUIRE(record);
+    REQUIRE(record->best_moves == make_move_coord_vec("a1:a8"));
+    REQUIRE(record->avoid_moves == make_move_coord_vec("h2:h3 g1:f1"));
+    REQUIRE(record->id == "mate; in one");
+    REQUIRE(!parse_epd("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - bm Ra9;"));
+    REQUIRE(!parse_epd("6k1/5ppp/8/8/8/8/5PPP/R5K1 w -"));
+
+    // EPD positions come without the counters.
+    const auto epd = parse_fen("8/8/8/3pP3/8/8/8/k6K w - d6");
+    REQUIRE(epd);
+    REQUIRE(epd->en_passant_file == 4);
+    REQUIRE(epd->move_count == 0);
+
+    REQUIRE(!parse_fen(""));
+    REQUIRE(!parse_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP w KQkq - 0 1"));
+    REQUIRE(!parse_fen("rnbqkbnr/pppppppp/9/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"));
+    REQUIRE(!parse_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNRR w KQkq - 0 1"));
+    REQUIRE(!parse_fen("rnbqkbnr/pppxpppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"));
+    REQUIRE(!parse_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR x KQkq - 0 1"));
+    REQUIRE(!parse_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkx - 0 1"));
+    REQUIRE(!parse_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq e3 0 1"));
+    REQUIRE(!parse_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0"));
+    REQUIRE(!parse_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1 extra"));
+
+    // Illegal positions: pawns on the back ranks, a missing or a second king, the player not to move in check.
+    REQUIRE(!parse_fen("P3k3/8/8/8/8/8/8/4K3 w - - 0 1"));
+    REQUIRE(!parse_fen("4k3/8/8/8/8/8/8/p3K3 b - - 0 1"));
+    REQUIRE(!parse_fen("8/8/8/8/8/8/8/4K3 w - - 0 1"));
+    REQUIRE(!parse_fen("4k3/8/8/8/8/8/8/8 b - - 0 1"));
+    REQUIRE(!parse_fen("4k3/8/8/8/8/8/8/K3K3 w - - 0 1"));
+    REQUIRE(!parse_fen("4k3/8/8/8/8/8/8/4K2k b - - 0 1"));
+    REQUIRE(!parse_fen("4k3/8/8/8/8/8/8/4R1K1 w - - 0 1"));
+    REQUIRE(parse_fen("4k3/8/8/8/8/8/8/4R1K1 b - - 0 1"));
+
+    // Every field of the states met in random games survives the round trip.
+    for (int game = 0; game < 10; ++game) {
+        auto n = make_start_node();
+        while (!is_terminal(n)) {
+            auto buffer = FenBuffer{};
+            const auto parsed = parse_fen(to_fen(n.state, buffer));
+            REQUIRE(parsed);
+            REQUIRE(std::memcmp(&*parsed, &n.state, sizeof(GameState)) == 0);
+            const auto& next_moves = n.next_moves();
+            n = make_move(n.state, next_moves[rand() % next_moves.size()]);
+        }
+    }
+}
+
+namespace {
+
+// Plays random games and writes them down as PGN.
+std::string make_random_pgn(size_t game_count, std::vector<GameState>* final_states = nullptr) {
+    auto pgn = std::string{};
+    for (size_t i = 0; i < game_count; ++i) {
+        pgn += "[Event \"Random\"]\n[Round \"" + std::to_string(i + 1) + "\"]\n\n";
+        auto n = make_start_node();
+        while (!is_terminal(n)) {
+            const auto& next_moves = n.next_moves();
+            const auto m = next_moves[rand() % next_moves.size()];
+            if (is_white(n.state.player_to_move)) pgn += std::to_string(n.state.move_count / 2 + 1) + ". ";
+            pgn += to_san_move(n.state, m) + " ";
+            n = make_move(n.state, m);
+        }
+        pgn += "*\n\n";
+        if (final_states) final_states->push_back(n.state);
+    }
+    return pgn;
+}
+
+} // namespace
+
+TEST_CASE("replay_pgn", "[pgn]") {
+    const auto pgn = std::string_view{
+        "[Event \"Scholar\"]\n"
+        "[Result \"1-0\"]\n"
+        "\n"
+        "1. e4 e5 2. Bc4 {A comment (with parentheses)} Nc6 (2... Nf6 3. d3 (3. Ng5)) 3. Qh5 $2 Nf6?? 4. Qxf7# 1-0\n"
+        "\n"
+        "[Event \"Illegal\"]\n"
+        "\n"
+        "1. e4 e5 2. Ke3 *\n"
+        "\n"
+        "[Event \"Setup\"]\n"
+        "[SetUp \"1\"]\n"
+        "[FEN \"4k3/8/8/8/8/8/8/4K3 w - - 0 1\"]\n"
+        "\n"
+        "1. Kd2 *\n"
+        "\n"
+        "[Event \"Fool\"]\n"
+        "\n"
+        "1.f3 e5 2.g4 ; The blunder\n"
+        "Qh4# 0-1\n"};
+
+    auto games = std::vector<PgnGame>{};
+    const auto stats = replay_pgn(pgn, 1, [&](const PgnGame& game) { games.push_back(game); });
+    REQUIRE(stats.games == 3);
+    REQUIRE(stats.skipped_games == 1);
+    REQUIRE(stats.positions == 15);
+    REQUIRE(games.size() == 3);
+
+    REQUIRE(games[0].result == GameResult::WhiteWon);
+    REQUIRE(games[0].moves == make_move_coord_vec("e2:e4 e7:e5 f1:c4 b8:c6 d1:h5 g8:f6 h5:f7"));
+    REQUIRE(games[0].states.size() == 8);
+    REQUIRE(!has_any_legal_move(games[0].states.back()));
+
+    REQUIRE(games[1].moves == make_move_coord_vec("e1:d2"));
+    REQUIRE(to_fen(games[1].states.back()) == "4k3/8/8/8/8/8/3K4/8 b - - 0 1");
+
+    REQUIRE(games[2].result == GameResult::BlackWon);
+    REQUIRE(games[2].moves == make_move_coord_vec("f2:f3 e7:e5 g2:g4 d8:h4"));
+
+    // Random games replayed concurrently reach the same final positions.
+    auto final_states = std::vector<GameState>{};
+    const auto random_pgn = make_random_pgn(20, &final_states);
+    auto replayed_states = std::vector<GameState>{};
+    auto replayed_mutex = std::mutex{};
+    const auto random_stats = replay_pgn(random_pgn, 4, [&](const PgnGame& game) {
+        const auto lock = std::lock_guard{replayed_mutex};
+        replayed_states.push_back(game.states.back());
+    });
+    REQUIRE(random_stats.games == 20);
+    REQUIRE(random_stats.skipped_games == 0);
+    const auto by_bytes = [](const GameState& a, const GameState& b) { return std::memcmp(&a, &b, sizeof(GameState)) < 0; };
+    std::sort(final_states.begin(), final_states.end(), by_bytes);
+    std::sort(replayed_states.begin(), replayed_states.end(), by_bytes);
+    REQUIRE(std::equal(final_states.begin(), final_states.end(), replayed_states.begin(), replayed_states.end(),
+        [](const GameState& a, const GameState& b) { return std::memcmp(&a, &b, sizeof(GameState)) == 0; }));
+}
+
+TEST_CASE("training_data", "[training_data]") {
+    // Positions of random games, with all kinds of field values.
+    auto records = std::vector<TrainingRecord>{};
+    while (records.size() < 3 * TrainingBlockRecords / 2) {
+        auto n = make_start_node();
+        while (!is_terminal(n)) {
+            const auto& next_moves = n.next_moves();
+            const auto m = next_moves[rand() % next_moves.size()];
+            records.push_back(TrainingRecord{n.state, (int16_t)(rand() % 2001 - 1000), GameResult::Draw, m});
+            n = make_move(n.state, m);
+        }
+        records.push_back(TrainingRecord{n.state, to_training_score(-MateValue), GameResult::BlackWon, MoveCoord{}});
+    }
+
+    const auto same = [](const TrainingRecord& a, const TrainingRecord& b) {
+        return std::memcmp(&a.state, &b.state, sizeof(GameState)) == 0 && a.score == b.score &&
+            a.result == b.result && a.best_move == b.best_move;
+    };
+
+    const auto dir = std::filesystem::temp_directory_path();
+    uint64_t file_sizes[2] = {};
+    for (const bool compress : {false, true}) {
+        const auto path = (dir / (compress ? "rookmole.test.compressed.rmtd" : "rookmole.test.rmtd")).string();
+        {
+            auto writer = TrainingDataWriter{path, compress};
+            REQUIRE(writer.is_open());
+            for (const auto& r : records) writer.write(r);
+            REQUIRE(writer.close());
+        }
+
+        auto reader = TrainingDataReader{path};
+        REQUIRE(reader.is_open());
+        REQUIRE(reader.is_compressed() == compress);
+        REQUIRE(reader.size() == records.size());
+        for (size_t i = 0; i < records.size(); ++i) {
+            REQUIRE(same(reader.read(i), records[i]));
+        }
+        // Random access, back and forth across the blocks.
+        for (int k = 0; k < 1000; ++k) {
+            const size_t i = rand() % records.size();
+            REQUIRE(same(reader.read(i), records[i]));
+        }
+        file_sizes[compress] = std::filesystem::file_size(path);
+        std::filesystem::remove(path);
+    }
+    REQUIRE(file_sizes[1] < file_sizes[0] / 2);
+
+    REQUIRE(to_training_score(MateValue - 3) == TrainingMateScore);
+    REQUIRE(to_training_score(100000) == TrainingMateScore - 1);
+    REQUIRE(to_training_score(-250) == -250);
+    REQUIRE(!TrainingDataReader{(dir / "rookmole.test.missing.rmtd").string()}.is_open());
+}
+
+TEST_CASE("opening_book", "[book]") {
+    const auto pgn = std::string_view{
+        "[Result \"1-0\"]\n\n1. e4 e5 2. Nf3 Nc6 1-0\n\n"
+        "[Result \"1/2-1/2\"]\n\n1. e4 c5 2. Nf3 1/2-1/2\n\n"
+        "[Result \"0-1\"]\n\n1. d4 d5 2. c4 0-1\n\n"
+        "[Result \"1-0\"]\n\n1. d4 Nf6 1-0\n\n"};
+
+    auto builder = OpeningBookBuilder{};
+    replay_pgn(pgn, 1, [&](const PgnGame& game) { builder.add_game(game, 3); });
+    const auto path = (std::filesystem::temp_directory_path() / "rookmole.test.book").string();
+    REQUIRE(builder.write(path));
+
+    const auto book = OpeningBook{path};
+    REQUIRE(book.is_open());
+    const auto s = make_start_state();
+    BookMove moves[8];
+    REQUIRE(book.probe(s, moves, 8) == 2);
+    REQUIRE(moves[0].weight + moves[1].weight == 2 + 1 + 2);
+    REQUIRE(book.best_move(s) == make_move_coord("e2:e4"));
+    REQUIRE(book.probe(s, moves, 1) == 2);
+
+    // Moves of the side which lost are left out.
+    const auto after_d4 = make_move(s, make_move_coord("d2:d4")).state;
+    REQUIRE(book.probe(after_d4, moves, 8) == 1);
+    REQUIRE(moves[0].move == make_move_coord("d7:d5"));
+    REQUIRE(moves[0].weight == 2);
+
+    // Beyond the ply limit.
+    auto after_nf3 = s;
+    for (const auto m : {"e2:e4", "e7:e5", "g1:f3"}) after_nf3 = make_move(after_nf3, make_move_coord(m)).state;
+    REQUIRE(book.probe(after_nf3, moves, 8) == 0);
+    REQUIRE(!book.best_move(after_nf3));
+
+    size_t picked_e4 = 0;
+    for (uint64_t r = 0; r < 5; ++r) picked_e4 += book.pick_move(s, r) == make_move_coord("e2:e4");
+    REQUIRE(picked_e4 == 3);
+
+    auto options = SearchOptions{};
+    options.book = &book;
+    const auto report = search(GameNode{s}, SearchLimits{}, SearchSignals{}, options);
+    REQUIRE(report.move == make_move_coord("e2:e4"));
+    REQUIRE(report.depth == 0);
+    const auto out_of_book = search(GameNode{after_nf3}, SearchLimits{2}, SearchSignals{}, options);
+    REQUIRE(out_of_book.depth == 2);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("tablebases", "[tablebase]") {
+    auto tablebases = Tablebases{};
+    REQUIRE(!tablebases.generate("KPK"));  // Promotes into KQK.
+    REQUIRE(!tablebases.generate("KKQ"));
+    REQUIRE(!tablebases.generate("KQRKP"));
+    REQUIRE(tablebases.generate("KQK", 2));
+    REQUIRE(tablebases.generate("KPK", 2));
+    REQUIRE(tablebases.size() == 2);
+
+    // The longest mates, with the losing side to move.
+    REQUIRE(tablebases.stats("KQK")->longest_mate == 20);
+    REQUIRE(tablebases.stats("KPK")->longest_mate == 56);
+
+    const auto probe = [&tablebases](std::string_view fen) {
+        const auto s = parse_fen(fen);
+        REQUIRE(s);
+        return tablebases.probe(*s);
+    };
+    const auto is = [](std::optional<TablebaseProbe> result, TablebaseWdl wdl, int plies) {
+        return result && result->wdl == wdl && result->plies == plies;
+    };
+    REQUIRE(is(probe("k7/8/1K6/8/8/8/7Q/8 w - - 0 1"), TablebaseWdl::Win, 1));
+    REQUIRE(is(probe("k6Q/8/1K6/8/8/8/8/8 b - - 0 1"), TablebaseWdl::Loss, 0));
+    REQUIRE(is(probe("k7/2Q5/1K6/8/8/8/8/8 b - - 0 1"), TablebaseWdl::Draw, 0));
+    REQUIRE(is(probe("K7/8/1k6/8/8/8/7q/8 b - - 0 1"), TablebaseWdl::Win, 1));  // Colors reversed.
+    REQUIRE(is(probe("k7/8/8/8/8/8/P7/4K3 w - - 0 1"), TablebaseWdl::Draw, 0));
+    REQUIRE(is(probe("k7/8/8/8/8/8/8/4K1N1 w - - 0 1"), TablebaseWdl::Draw, 0));
+    REQUIRE(probe("3k4/8/3K4/3P4/8/8/8/8 b - - 0 1")->wdl == TablebaseWdl::Loss);
+    REQUIRE(!probe("4k3/8/8/8/8/8/8/R3K3 w - - 0 1"));
+    REQUIRE(!tablebases.probe(make_start_state()));
+
+    // The search plays the quickest mate from the tables.
+    const auto root = *parse_fen("8/8/8/4k3/8/8/8/4K2Q w - - 0 1");
+    const auto root_probe = tablebases.probe(root);
+    REQUIRE(root_probe->wdl == TablebaseWdl::Win);
+    auto options = SearchOptions{};
+    options.tablebases = &tablebases;
+    const auto report = search(GameNode{root}, SearchLimits{2}, SearchSignals{}, options);
+    REQUIRE(mate_in_moves(report.value) == (root_probe->plies + 1) / 2);
+    REQUIRE(is(tablebases.probe(make_move(root, report.move).state), TablebaseWdl::Loss, root_probe->plies - 1));
+
+    // The mates longer than the search depth, as in KQKR (70 plies) or KRKP (85), are still mate scores.
+    const auto long_loss = TablebaseProbe{TablebaseWdl::Loss, 84};
+    REQUIRE(mate_in_moves(tablebase_value(long_loss, Player::Black, Player::Black, 1)) == -42);
+    REQUIRE(mate_in_moves(tablebase_value(long_loss, Player::Black, Player::White, 1)) == 43);
+    REQUIRE(mate_in_moves(tablebase_value(TablebaseProbe{TablebaseWdl::Win, MaxTablebaseMatePlies}, Player::White,
+        Player::White, MaxSearchDepth)) == (MaxMatePlies + 1) / 2);
+
+    // Written and mapped back.
+    const auto directory = std::filesystem::temp_directory_path().string();
+    REQUIRE(tablebases.write(directory, "KQK"));
+    auto mapped = Tablebases{};
+    REQUIRE(mapped.load(directory, "KQK"));
+    REQUIRE(!mapped.load(directory, "KBNK"));
+    REQUIRE(mapped.size() == 1);
+    REQUIRE(mapped.probe(root)->plies == root_probe->plies);
+    REQUIRE(mapped.stats("KQK")->positions == tablebases.stats("KQK")->positions);
+    std::filesystem::remove(std::filesystem::temp_directory_path() / tablebase_file_name("KQK"));
+}
+
+TEST_CASE("mate_in_one", "[search]") {
+    auto n = make_start_node();
+    for (const auto move : make_move_coord_vec("f2:f3 e7:e5 g2:g4")) {
+        n = make_move(n.state, move);
+    }
+
+    const auto signals = SearchSignals{};
+    int iterations = 0;
+    const auto report = search(n, SearchLimits{4, 0}, signals, [&iterations](const SearchReport&) { ++iterations; });
+    REQUIRE(report.move == make_move_coord("d8:h4"));
+    REQUIRE(mate_in_moves(report.value) == 1);
+    REQUIRE(report.pv == make_move_coord_vec("d8:h4"));
+    REQUIRE(report.depth == 1);
+    REQUIRE(iterations == 1);
+}
+
+TEST_CASE("search_limits", "[search]") {
+    const auto root = make_start_node();
+    auto signals = SearchSignals{};
+
+    const auto by_depth = search(root, SearchLimits{3, 0}, signals);
+    REQUIRE(by_depth.depth == 3);
+    REQUIRE(by_depth.pv.size() == 3);
+    REQUIRE(is_move_coord_legal(root.next_moves(), by_depth.move));
+
+    const auto by_nodes = search(root, SearchLimits{MaxSearchDepth, 2000}, signals);
+    REQUIRE(by_nodes.depth >= 1);
+    REQUIRE(by_nodes.nodes == 2000);
+    REQUIRE(is_move_coord_legal(root.next_moves(), by_nodes.move));
+
+    auto stopper = std::thread{[&signals] {
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        signals.stop = true;
+    }};
+    const auto stopped = search(root, SearchLimits{}, signals);
+    stopper.join();
+    REQUIRE(stopped.depth >= 1);
+    REQUIRE(stopped.depth < MaxSearchDepth);
+    REQUIRE(is_move_coord_legal(root.next_moves(), stopped.move));
+}
+
+TEST_CASE("search_options", "[search]") {
+    const auto root = GameNode{*parse_fen("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3")};
+
+    // Move ordering only affects the number of nodes visited, not the value.
+    auto unordered_options = SearchOptions{};
+    unordered_options.move_ordering = false;
+    auto ordered_ctx = SearchContext{};
+    auto unordered_ctx = SearchContext{};
+    unordered_ctx.options = unordered_options;
+    const auto ordered = alphabeta(ordered_ctx, root, 3);
+    const auto unordered = alphabeta(unordered_ctx, root, 3);
+    REQUIRE(ordered.value == unordered.value);
+    REQUIRE(ordered_ctx.nodes < unordered_ctx.nodes);
+
+    auto basic_options = SearchOptions{};
+    basic_options.evaluate = evaluate_basic;
+    const auto mate = search(GameNode{*parse_fen("6k1/5ppp/8/8/8/8/5PPP/1R4K1 w - - 0 1")}, SearchLimits{3}, SearchSignals{}, basic_options);
+    REQUIRE(mate.move == make_move_coord("b1:b8"));
+    REQUIRE(mate_in_moves(mate.value) == 1);
+    REQUIRE(evaluate_basic(Player::White, root) == evaluate_material(Player::White, root.state));
+}
+
+TEST_CASE("quiescence", "[search]") {
+    // The pawn on d5 is defended: taking it loses the queen, beyond the horizon of a one-ply search.
+    const auto root = GameNode{*parse_fen("4k3/8/4p3/3p4/8/8/8/3QK3 w - - 0 1")};
+
+    auto horizon_ctx = SearchContext{};
+    horizon_ctx.options.quiescence = false;
+    REQUIRE(alphabeta(horizon_ctx, root, 1).move == make_move_coord("d1:d5"));
+
+    auto ctx = SearchContext{};
+    const auto result = alphabeta(ctx, root, 1);
+    REQUIRE(result.move != make_move_coord("d1:d5"));
+    REQUIRE(is_move_coord_legal(root.next_moves(), result.move));
+    REQUIRE(ctx.nodes > horizon_ctx.nodes);
+}
+
+TEST_CASE("search_stats", "[search]") {
+    const auto root = GameNode{*parse_fen("r1bqkbnr/pppp1ppp/2n5/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R b KQkq - 3 3")};
+    for (const int threads : {1, 2}) {
+        const auto report = search(root, SearchLimits{3, 0, threads}, SearchSignals{});
+        const auto& stats = report.stats;
+        REQUIRE(stats.nodes == report.nodes);
+        REQUIRE(to_json(stats).find("\"nodes\": " + std::to_string(report.nodes)) != std::string::npos);
+
+        if constexpr (SearchStatsEnabled) {
+            uint64_t nodes_by_ply = 0;
+            for (const auto n : stats.nodes_by_ply) nodes_by_ply += n;
+            REQUIRE(nodes_by_ply == stats.nodes);
+            REQUIRE(stats.nodes_by_ply[0] == 3);  // One root node per iteration.
+            uint64_t beyond_depth = 0;  // Searched by the quiescence only.
+            for (size_t ply = 4; ply < stats.nodes_by_ply.size(); ++ply) beyond_depth += stats.nodes_by_ply[ply];
+            REQUIRE(beyond_depth <= stats.quiescence_nodes);
+            REQUIRE(stats.quiescence_nodes > 0);
+            REQUIRE(stats.leaf_nodes > stats.nodes / 2);
+            REQUIRE(stats.cutoffs > 0);
+            REQUIRE(stats.first_move_cutoffs <= stats.cutoffs);
+            REQUIRE(stats.eval_nsec > 0);
+            REQUIRE(stats.movegen_nsec > 0);
+        }
+        else {
+            REQUIRE(stats.leaf_nodes == 0);
+            REQUIRE(to_json(stats).find("leaf_nodes") == std::string::npos);
+        }
+    }
+}
+
+TEST_CASE("search_threads", "[search]") {
+    const auto root = GameNode{*parse_fen("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3")};
+    auto signals = SearchSignals{};
+
+    const auto single = search(root, SearchLimits{3, 0, 1}, signals);
+    for (const int threads : {2, 4}) {
+        const auto split = search(root, SearchLimits{3, 0, threads}, signals);
+        REQUIRE(split.depth == 3);
+        REQUIRE(split.value == single.value);
+        REQUIRE(split.pv.size() == 3);
+        REQUIRE(split.pv.front() == split.move);
+        REQUIRE(is_move_coord_legal(root.next_moves(), split.move));
+    }
+
+    // A mate is found by whichever thread searches the mating move.
+    const auto mate = search(GameNode{*parse_fen("6k1/5ppp/8/8/8/8/5PPP/1R4K1 w - - 0 1")}, SearchLimits{4, 0, 3}, signals);
+    REQUIRE(mate.move == make_move_coord("b1:b8"));
+    REQUIRE(mate_in_moves(mate.value) == 1);
+}
+
+TEST_CASE("zero_allocation", "[search]") {
+    const auto root = GameNode{*parse_fen("r1bqkbnr/pppp1ppp/2n5/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R b KQkq - 3 3")};
+
+    auto before = allocation_counts();
+    REQUIRE(perft(root.state, 3) > 0);
+    REQUIRE((allocation_counts() - before).allocations == 0);
+
+    // Once its buffers are allocated, a context searches without allocating, move ordering and all.
+    auto ctx = SearchContext{};
+    alphabeta(ctx, root, 3);
+    before = allocation_counts();
+    const auto nodes_before = ctx.nodes;
+    alphabeta(ctx, root, 3);
+    REQUIRE(ctx.nodes > nodes_before);
+    REQUIRE((allocation_counts() - before).allocations == 0);
+
+    // Unordered, the quiescence may reach plies the ordered search has no buffers for yet.
+    ctx.options.move_ordering = false;
+    alphabeta(ctx, root, 3);
+    before = allocation_counts();
+    alphabeta(ctx, root, 3);
+    REQUIRE((allocation_counts() - before).allocations == 0);
+}
+
+TEST_CASE("bench_signature", "[search]") {
+    for (const auto fen : BenchmarkFens) {
+        REQUIRE(parse_fen(fen));
+    }
+
+    uint64_t position_nodes = 0;
+    size_t positions = 0;
+    const auto report = run_search_benchmark(2, [&](size_t index, const SearchReport& r) {
+        REQUIRE(index == positions++);
+        position_nodes += r.nodes;
+    });
+    REQUIRE(positions == BenchmarkPositionCount);
+    REQUIRE(report.nodes == position_nodes);
+
+    // The signature does not depend on the state left by the previous searches.
+    REQUIRE(run_search_benchmark(2).nodes == report.nodes);
+}
+
+TEST_CASE("chrome_trace", "[trace]") {
+    start_tracing();
+    const auto root = GameNode{*parse_fen("r1bqkbnr/pppp1ppp/2n5/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R b KQkq - 3 3")};
+    search(root, SearchLimits{2, 0, 2}, SearchSignals{});
+    stop_tracing();
+    REQUIRE(!is_tracing());
+
+    const auto path = (std::filesystem::temp_directory_path() / "rookmole.test.trace.json").string();
+    REQUIRE(write_chrome_trace(path));
+    auto text = std::string{};
+    {
+        const auto file = MappedFile{path};
+        REQUIRE(file.is_open());
+        text = file.view();
+    }
+    REQUIRE(text.rfind("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [", 0) == 0);
+    REQUIRE(text.find("]}") != std::string::npos);
+    const auto has = [&text](std::string_view name) { return text.find(name) != std::string::npos; };
+    if constexpr (TracingEnabled) {
+        REQUIRE(has("\"name\": \"iteration\", \"ph\": \"X\""));
+        REQUIRE(has("\"name\": \"root move\", \"ph\": \"i\""));
+        REQUIRE(has("\"name\": \"task\""));
+        REQUIRE(has("\"name\": \"pool worker\""));
+    }
+    else {
+        REQUIRE(!has("\"ph\""));
+    }
+
+    // Nothing is recorded once stopped.
+    search(root, SearchLimits{1}, SearchSignals{});
+    REQUIRE(write_chrome_trace(path));
+    REQUIRE(MappedFile{path}.view() == text);
+    std::filesystem::remove(path);
+
+    // Nor are the event buffers of the new pool threads allocated, named as they are.
+    const auto before = allocation_counts();
+    search(root, SearchLimits{1, 0, 2}, SearchSignals{});
+    REQUIRE((allocation_counts() - before).bytes < (1 << 20));
+}
+
 TEST_CASE("openings_depth3", "[perf]") {
     using Clock = std::chrono::high_resolution_clock;
     constexpr size_t depth = 3;
     const auto s0 = make_start_state();
-    auto msv = std::vector<GameNode>{GameNode{std::move(s0), get_legal_moves(s0), false}};
+    auto msv = std::vector<GameNode>{GameNode{s0}};
 
     auto start_time = Clock::now();
     for (size_t i = 0; i < depth; ++i) {
         auto msv_next = std::vector<GameNode>{};
         msv_next.reserve(msv.size() * 32);
         for (const auto& ms : msv) {
-            for (const auto m : ms.next_moves) {
+            for (const auto m : ms.next_moves()) {
                 msv_next.push_back(make_move(ms.state, m));
             }
         }
@@ -163,21 +1077,58 @@ TEST_CASE("openings_depth3", "[perf]") {
     std::cout << "Evaluated all " << msv.size() << " states for depth " << depth << " in " << (double)dur_msec / 1000.0 << " sec" << std::endl;
 }
 
+TEST_CASE("evaluate_batch_depth3", "[perf]") {
+    using Clock = std::chrono::high_resolution_clock;
+    constexpr size_t depth = 3;
+    constexpr int repetitions = 20;
+
+    auto states = std::vector<GameState>{make_start_state()};
+    for (size_t i = 0; i < depth; ++i) {
+        auto states_next = std::vector<GameState>{};
+        for (const auto& s : states) {
+            for (const auto m : get_legal_moves(s)) {
+                states_next.push_back(make_move(s, m).state);
+            }
+        }
+        states = std::move(states_next);
+    }
+
+    auto scores = std::vector<int>(states.size());
+
+    auto start_time = Clock::now();
+    for (int r = 0; r < repetitions; ++r) {
+        for (size_t i = 0; i < states.size(); ++i) {
+            scores[i] = evaluate_material(Player::White, states[i]);
+        }
+    }
+    auto end_time = Clock::now();
+    auto dur_usec = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    std::cout << "Material of " << states.size() << " states evaluated " << repetitions << " times one by one in " << (double)dur_usec / 1000000.0 << " sec" << std::endl;
+
+    start_time = Clock::now();
+    for (int r = 0; r < repetitions; ++r) {
+        evaluate_batch(Player::White, states.data(), scores.data(), states.size());
+    }
+    end_time = Clock::now();
+    dur_usec = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    std::cout << "Material of " << states.size() << " states evaluated " << repetitions << " times in batches in " << (double)dur_usec / 1000000.0 << " sec" << std::endl;
+}
+
 TEST_CASE("random_moves", "[perf]") {
     using Clock = std::chrono::high_resolution_clock;
     constexpr size_t game_count = 1000;
     const auto s0 = make_start_state();
-    const auto lm0 = get_legal_moves(s0);
 
     auto start_time = Clock::now();
     for (size_t i = 0; i < game_count; ++i) {
-        auto n = GameNode{s0, lm0, false};
+        auto n = GameNode{s0};
 
         do {
-            if (n.next_moves.empty()) break;
-            int move_index = (int)(rand() % n.next_moves.size());
-            n = make_move(n.state, n.next_moves[move_index]);
-        } while (!n.next_moves.empty() && n.state.move_count <= 80);
+            const auto& next_moves = n.next_moves();
+            if (next_moves.empty()) break;
+            int move_index = (int)(rand() % next_moves.size());
+            n = make_move(n.state, next_moves[move_index]);
+        } while (n.has_any_legal_move() && n.state.move_count <= 80);
     }
 
     auto end_time = Clock::now();
@@ -185,15 +1136,203 @@ TEST_CASE("random_moves", "[perf]") {
     std::cout << "Random games played (80 moves): " << (1000.0 * (double)game_count / (double)dur_msec) << " games/sec" << std::endl;
 }
 
+TEST_CASE("replay_pgn_games", "[perf]") {
+    using Clock = std::chrono::high_resolution_clock;
+    constexpr int repetitions = 10;
+
+    const auto games = make_random_pgn(200);
+    auto pgn = std::string{};
+    for (int i = 0; i < repetitions; ++i) pgn += games;
+
+    const int thread_count = std::max(1, (int)std::thread::hardware_concurrency());
+    auto positions = std::atomic<uint64_t>{0};
+
+    auto start_time = Clock::now();
+    const auto stats = replay_pgn(pgn, thread_count, [&](const PgnGame& game) { positions += game.states.size(); });
+    auto end_time = Clock::now();
+
+    REQUIRE(stats.games == 200 * repetitions);
+    REQUIRE(stats.positions == positions);
+    auto dur_usec = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    std::cout << "PGN replayed on " << thread_count << " threads: " << (1000000.0 * (double)stats.games / (double)dur_usec) <<
+        " games/sec, " << (1000000.0 * (double)stats.positions / (double)dur_usec) << " positions/sec" << std::endl;
+}
+
+TEST_CASE("fen_round_trip", "[perf]") {
+    using Clock = std::chrono::high_resolution_clock;
+    constexpr int repetitions = 20;
+
+    auto fens = std::vector<std::string>{};
+    for (int game = 0; game < 100; ++game) {
+        auto n = make_start_node();
+        while (!is_terminal(n)) {
+            fens.push_back(to_fen(n.state));
+            const auto& next_moves = n.next_moves();
+            n = make_move(n.state, next_moves[rand() % next_moves.size()]);
+        }
+    }
+
+    auto start_time = Clock::now();
+    auto move_count_sum = uint64_t{0};
+    for (int i = 0; i < repetitions; ++i) {
+        for (const auto& fen : fens) move_count_sum += parse_fen(fen)->move_count;
+    }
+    auto end_time = Clock::now();
+    const auto parse_usec = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+
+    auto states = std::vector<GameState>{};
+    for (const auto& fen : fens) states.push_back(*parse_fen(fen));
+
+    start_time = Clock::now();
+    auto length_sum = uint64_t{0};
+    auto buffer = FenBuffer{};
+    for (int i = 0; i < repetitions; ++i) {
+        for (const auto& s : states) length_sum += to_fen(s, buffer).size();
+    }
+    end_time = Clock::now();
+    const auto write_usec = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+
+    REQUIRE(move_count_sum > 0);
+    REQUIRE(length_sum > 0);
+    const double position_count = (double)fens.size() * repetitions;
+    std::cout << "FEN parsed: " << (1000000.0 * position_count / (double)std::max<int64_t>(parse_usec, 1)) <<
+        " positions/sec, written: " << (1000000.0 * position_count / (double)std::max<int64_t>(write_usec, 1)) << " positions/sec" << std::endl;
+}
+
+TEST_CASE("training_data_throughput", "[perf]") {
+    using Clock = std::chrono::high_resolution_clock;
+    constexpr int repetitions = 20;
+
+    auto records = std::vector<TrainingRecord>{};
+    for (int game = 0; game < 100; ++game) {
+        auto n = make_start_node();
+        while (!is_terminal(n)) {
+            const auto& next_moves = n.next_moves();
+            const auto m = next_moves[rand() % next_moves.size()];
+            records.push_back(TrainingRecord{n.state, (int16_t)(rand() % 200), GameResult::WhiteWon, m});
+            n = make_move(n.state, m);
+        }
+    }
+
+    const auto path = (std::filesystem::temp_directory_path() / "rookmole.perf.rmtd").string();
+    for (const bool compress : {false, true}) {
+        auto start_time = Clock::now();
+        {
+            auto writer = TrainingDataWriter{path, compress};
+            for (int i = 0; i < repetitions; ++i) {
+                for (const auto& r : records) writer.write(r);
+            }
+            REQUIRE(writer.close());
+        }
+        const auto write_usec = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start_time).count();
+
+        start_time = Clock::now();
+        auto reader = TrainingDataReader{path};
+        int64_t score_sum = 0;
+        for (uint64_t i = 0; i < reader.size(); ++i) score_sum += reader.read(i).score;
+        const auto read_usec = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start_time).count();
+
+        REQUIRE(reader.size() == records.size() * repetitions);
+        REQUIRE(score_sum > 0);
+        const double count = (double)reader.size();
+        std::cout << "Training data" << (compress ? " (compressed)" : "") << ": " <<
+            ((double)std::filesystem::file_size(path) / count) << " bytes/record, written " <<
+            (1000000.0 * count / (double)std::max<int64_t>(write_usec, 1)) << " records/sec, read " <<
+            (1000000.0 * count / (double)std::max<int64_t>(read_usec, 1)) << " records/sec" << std::endl;
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("book_probe", "[perf]") {
+    using Clock = std::chrono::high_resolution_clock;
+
+    auto builder = OpeningBookBuilder{};
+    auto states = std::vector<GameState>{};
+    for (int game = 0; game < 2000; ++game) {
+        auto n = make_start_node();
+        for (int ply = 0; ply < 16 && !is_terminal(n); ++ply) {
+            const auto& next_moves = n.next_moves();
+            const auto m = next_moves[rand() % next_moves.size()];
+            builder.add(n.state, m, 1);
+            states.push_back(n.state);
+            n = make_move(n.state, m);
+        }
+    }
+    const auto path = (std::filesystem::temp_directory_path() / "rookmole.perf.book").string();
+    REQUIRE(builder.write(path));
+    const auto book = OpeningBook{path};
+
+    auto start_time = Clock::now();
+    uint64_t found = 0;
+    BookMove moves[64];
+    for (int i = 0; i < 20; ++i) {
+        for (const auto& s : states) found += book.probe(s, moves, 64);
+    }
+    const auto dur_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_time).count();
+
+    REQUIRE(found >= 20 * states.size());
+    std::cout << "Opening book of " << book.size() << " entries probed in " <<
+        ((double)dur_nsec / (20.0 * (double)states.size())) << " ns" << std::endl;
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("tablebase_generation", "[perf]") {
+    using Clock = std::chrono::high_resolution_clock;
+
+    auto start_time = Clock::now();
+    auto tablebases = Tablebases{};
+    REQUIRE(tablebases.generate("KRK"));
+    const auto gen_dur_msec = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start_time).count();
+
+    auto states = std::vector<GameState>{};
+    for (int i = 0; i < 1000; ++i) {
+        auto s = GameState{};
+        s.set_square(coord_of(rand() % 64), Square::WhiteKing);
+        s.set_square(coord_of(rand() % 64), Square::WhiteRook);
+        s.set_square(coord_of(rand() % 64), Square::BlackKing);
+        states.push_back(s);
+    }
+
+    start_time = Clock::now();
+    uint64_t covered = 0;
+    for (int i = 0; i < 100; ++i) {
+        for (const auto& s : states) covered += tablebases.probe(s).has_value();
+    }
+    const auto dur_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_time).count();
+
+    REQUIRE(covered > 0);
+    std::cout << "KRK generated in " << gen_dur_msec << " ms, probed in " <<
+        ((double)dur_nsec / (100.0 * (double)states.size())) << " ns" << std::endl;
+}
+
+TEST_CASE("search_allocations", "[perf]") {
+    // The allocations of the whole iterative deepening: of its contexts, threads and reports, and of the first visits
+    // of the plies.
+    const auto root = GameNode{*parse_fen("r1bqkbnr/pppp1ppp/2n5/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R b KQkq - 3 3")};
+    for (const int threads : {1, 2}) {
+        const auto before = allocation_counts();
+        const auto report = search(root, SearchLimits{4, 0, threads}, SearchSignals{});
+        const auto allocations = allocation_counts() - before;
+        REQUIRE(report.nodes > 0);
+        std::cout << "Search with " << threads << " thread(s): " << report.nodes << " nodes, " <<
+            ((double)allocations.allocations / (double)report.nodes) << " allocations and " <<
+            ((double)allocations.bytes / (double)report.nodes) << " bytes per node" << std::endl;
+    }
+}
+
 TEST_CASE("play_alphabeta_depth3", "[perf]") {
     using Clock = std::chrono::high_resolution_clock;
     constexpr int depth = 3;
 
     auto start_time = Clock::now();
     auto node = make_start_node();
+    auto pawn_hash = HashTableStats{};
+    auto eval_cache = HashTableStats{};
 
     while (!is_terminal(node)) {
         const auto best_result = alphabeta(node, depth);
+        pawn_hash = pawn_hash + best_result.stats.pawn_hash;
+        eval_cache = eval_cache + best_result.stats.eval_cache;
         node = make_move(node.state, best_result.move);
     }
 
@@ -201,5 +1340,6 @@ TEST_CASE("play_alphabeta_depth3", "[perf]") {
     auto dur_msec = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
     std::cout << "Game played with search depth " << depth <<
         " ended after " << (int)node.state.move_count << " moves in " <<
-        ((double)dur_msec / 1000.0) << " sec" << std::endl;
+        ((double)dur_msec / 1000.0) << " sec (pawn hash hit rate: " << (100.0 * pawn_hash.hit_rate()) <<
+        "%, eval cache hit rate: " << (100.0 * eval_cache.hit_rate()) << "%)" << std::endl;
 }
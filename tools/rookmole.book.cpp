@@ -0,0 +1,146 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <rookmole/rookmole.h>
+using namespace rookmole;
+
+// Builds an opening book from PGN files and self-play training data, or lists the book moves of a position.
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+bool ends_with(const std::string& text, std::string_view suffix)
+{
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+int build(int argc, char* argv[])
+{
+    auto output = std::string{};
+    auto inputs = std::vector<std::string>{};
+    int max_plies = 16;
+    uint32_t min_weight = 2;
+    int threads = 0;
+
+    for (int i = 2; i < argc; ++i) {
+        const auto arg = std::string_view{argv[i]};
+        const bool has_value = i + 1 < argc;
+        if (arg == "--plies" && has_value) max_plies = std::atoi(argv[++i]);
+        else if (arg == "--min-weight" && has_value) min_weight = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if (arg == "--threads" && has_value) threads = std::atoi(argv[++i]);
+        else if (output.empty()) output = arg;
+        else inputs.emplace_back(arg);
+    }
+    if (output.empty() || inputs.empty()) return 2;
+
+    auto builder = OpeningBookBuilder{};
+    auto builder_mutex = std::mutex{};
+
+    for (const auto& input : inputs) {
+        if (ends_with(input, ".pgn")) {
+            const auto stats = replay_pgn_file(input, threads, [&](const PgnGame& game) {
+                const auto lock = std::lock_guard{builder_mutex};
+                builder.add_game(game, max_plies);
+            });
+            if (!stats) {
+                std::cerr << "Cannot open " << input << std::endl;
+                return 1;
+            }
+            std::cout << input << ": " << stats->games << " games (" << stats->skipped_games << " skipped)" << std::endl;
+        }
+        else {
+            // Training data: the best moves found in the early positions, weighted by the results.
+            auto reader = TrainingDataReader{input};
+            if (!reader.is_open()) {
+                std::cerr << "Cannot open " << input << std::endl;
+                return 1;
+            }
+            uint64_t added = 0;
+            for (uint64_t i = 0; i < reader.size(); ++i) {
+                const auto record = reader.read(i);
+                if (is_invalid(record.best_move.from) || 2 * record.state.move_count >= max_plies) continue;
+                const auto me = record.state.player_to_move;
+                const bool lost = (record.result == GameResult::WhiteWon && is_black(me)) ||
+                    (record.result == GameResult::BlackWon && is_white(me));
+                const bool won = (record.result == GameResult::WhiteWon && is_white(me)) ||
+                    (record.result == GameResult::BlackWon && is_black(me));
+                if (lost) continue;
+                builder.add(record.state, record.best_move, won ? 2 : 1);
+                ++added;
+            }
+            std::cout << input << ": " << added << " positions" << std::endl;
+        }
+    }
+
+    if (!builder.write(output, min_weight)) {
+        std::cerr << "Cannot write " << output << std::endl;
+        return 1;
+    }
+    std::cout << "Book written: " << OpeningBook{output}.size() << " entries" << std::endl;
+    return 0;
+}
+
+int probe(int argc, char* argv[])
+{
+    if (argc < 4) return 2;
+    const auto book = OpeningBook{argv[2]};
+    if (!book.is_open()) {
+        std::cerr << "Cannot open " << argv[2] << std::endl;
+        return 1;
+    }
+
+    auto fen = std::string{};
+    for (int i = 3; i < argc; ++i) {
+        if (!fen.empty()) fen.push_back(' ');
+        fen.append(argv[i]);
+    }
+    const auto state = fen == "startpos" ? std::optional{make_start_state()} : parse_fen(fen);
+    if (!state) {
+        std::cerr << "Invalid FEN: " << fen << std::endl;
+        return 1;
+    }
+
+    BookMove moves[64];
+    const size_t count = std::min(book.probe(*state, moves, std::size(moves)), std::size(moves));
+    for (size_t i = 0; i < count; ++i) {
+        std::cout << to_san_move(*state, moves[i].move) << ' ' << moves[i].weight << '\n';
+    }
+    if (count == 0) std::cout << "Out of book" << std::endl;
+    return 0;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+int main(int argc, char* argv[])
+{
+    const auto command = argc > 1 ? std::string_view{argv[1]} : std::string_view{};
+    int exit_code = 2;
+    if (command == "build") exit_code = build(argc, argv);
+    else if (command == "probe") exit_code = probe(argc, argv);
+
+    if (exit_code == 2) {
+        std::cerr << "Usage: rookmole.book build <book> <input.pgn|input.rmtd>... [options]\n"
+            "         --plies N       Moves deeper than N plies are left out (the default is 16).\n"
+            "         --min-weight N  Moves weighing less are left out (the default is 2).\n"
+            "         --threads N     PGN replay threads (the default is one per hardware thread).\n"
+            "       rookmole.book probe <book> <fen|startpos>\n";
+    }
+    return exit_code;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
@@ -0,0 +1,204 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <rookmole/rookmole.h>
+using namespace rookmole;
+
+// Generates training data by self-play: every thread plays games from randomized openings with a fixed node budget
+// per move and records the quiet positions together with their search scores and the final results.
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+struct Options {
+    std::string output;
+    uint64_t positions = 100000;
+    uint64_t nodes = 5000;
+    int threads = 0;
+    int random_plies = 8;
+    bool compress = false;
+    uint64_t seed = 1;
+};
+
+struct Sink {
+    TrainingDataWriter writer;
+    std::unordered_set<uint64_t> seen;  // Zobrist keys of the positions written.
+    uint64_t games = 0;
+    uint64_t duplicates = 0;
+    uint64_t filtered = 0;
+    std::mutex mutex;
+
+    Sink(const std::string& path, bool compress) : writer{path, compress} {}
+};
+
+// Positions where the static evaluation is unreliable: the side to move is in check, or the best move wins or
+// changes material.
+bool is_tactical(const GameNode& node, MoveCoord best_move, int value)
+{
+    if (node.king_in_check()) return true;
+    if (mate_in_moves(value) != 0) return true;
+    const auto& s = node.state;
+    if (!is_empty(s(best_move.to))) return true;
+    const bool pawn_move = piece_of(s(best_move.from)) == Piece::Pawn;
+    return pawn_move && (best_move.to.rank == 1 || best_move.to.rank == 8 || best_move.from.file != best_move.to.file);
+}
+
+GameNode make_random_opening(std::mt19937_64& rng, int plies)
+{
+    for (;;) {
+        auto node = make_start_node();
+        for (int i = 0; i < plies && !is_terminal(node); ++i) {
+            const auto& next_moves = node.next_moves();
+            node = make_move(node.state, next_moves[rng() % next_moves.size()]);
+        }
+        if (!is_terminal(node)) return node;
+    }
+}
+
+void play_games(const Options& options, uint64_t thread_seed, Sink& sink, std::atomic<bool>& stop)
+{
+    auto rng = std::mt19937_64{thread_seed};
+    auto game_records = std::vector<TrainingRecord>{};
+    auto limits = SearchLimits{};
+    limits.nodes = options.nodes;
+
+    while (!stop) {
+        // An even or odd number of random plies, so that both colors start the game proper.
+        auto node = make_random_opening(rng, options.random_plies + static_cast<int>(rng() % 2));
+        game_records.clear();
+        uint64_t filtered = 0;
+
+        while (!is_terminal(node) && !stop) {
+            const auto report = search(node, limits, SearchSignals{});
+            if (is_tactical(node, report.move, report.value)) {
+                ++filtered;
+            }
+            else {
+                game_records.push_back(TrainingRecord{node.state, to_training_score(report.value), GameResult::Unknown, report.move});
+            }
+            node = make_move(node.state, report.move);
+        }
+        if (stop) break;
+
+        auto result = GameResult::Draw;  // Stalemate or the move limit.
+        if (!node.has_any_legal_move() && node.king_in_check()) {
+            result = is_white(node.state.player_to_move) ? GameResult::BlackWon : GameResult::WhiteWon;
+        }
+
+        const auto lock = std::lock_guard{sink.mutex};
+        ++sink.games;
+        sink.filtered += filtered;
+        for (auto& record : game_records) {
+            if (sink.writer.record_count() >= options.positions) {
+                stop = true;
+                break;
+            }
+            if (!sink.seen.insert(zobrist_key(record.state)).second) {
+                ++sink.duplicates;
+                continue;
+            }
+            record.result = result;
+            sink.writer.write(record);
+        }
+    }
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+int main(int argc, char* argv[])
+{
+    auto options = Options{};
+    bool usage = false;
+    for (int i = 1; i < argc && !usage; ++i) {
+        const auto arg = std::string_view{argv[i]};
+        const bool has_value = i + 1 < argc;
+        if (arg == "--positions" && has_value) options.positions = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--nodes" && has_value) options.nodes = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--threads" && has_value) options.threads = std::atoi(argv[++i]);
+        else if (arg == "--random-plies" && has_value) options.random_plies = std::atoi(argv[++i]);
+        else if (arg == "--seed" && has_value) options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--compress") options.compress = true;
+        else if (!arg.empty() && arg[0] != '-' && options.output.empty()) options.output = arg;
+        else usage = true;
+    }
+
+    if (usage || options.output.empty()) {
+        std::cerr << "Usage: rookmole.datagen <output> [options]\n"
+            "  --positions N     The number of positions to write (the default is 100000).\n"
+            "  --nodes N         The node budget of each move (the default is 5000).\n"
+            "  --threads N       Concurrent games (the default is one per hardware thread).\n"
+            "  --random-plies N  Random moves opening each game (the default is 8, or 9).\n"
+            "  --seed N          The seed of the random openings.\n"
+            "  --compress        Write compressed blocks.\n";
+        return 2;
+    }
+    if (options.threads <= 0) options.threads = hardware_thread_count();
+
+    auto sink = Sink{options.output, options.compress};
+    if (!sink.writer.is_open()) {
+        std::cerr << "Cannot create " << options.output << std::endl;
+        return 1;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const auto start_time = Clock::now();
+    auto stop = std::atomic<bool>{false};
+    auto done = std::atomic<int>{0};
+    auto last_report = 0.0;
+
+    {
+        auto pool = ThreadPool{options.threads};
+        for (int i = 0; i < options.threads; ++i) {
+            pool.submit([&, i] {
+                play_games(options, options.seed * 0x9E3779B97F4A7C15 + i, sink, stop);
+                ++done;
+            });
+        }
+
+        while (done < options.threads) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{100});
+            const auto elapsed = std::chrono::duration<double>(Clock::now() - start_time).count();
+
+            if (elapsed - last_report < 10.0 && done < options.threads) continue;
+            last_report = elapsed;
+
+            const auto lock = std::lock_guard{sink.mutex};
+            std::cout << std::fixed << std::setprecision(0) << "Positions " << sink.writer.record_count() <<
+                ", games " << sink.games << ", " << (3600.0 * (double)sink.writer.record_count() / elapsed) <<
+                " positions/hour" << std::endl;
+        }
+    }
+
+    const auto elapsed = std::chrono::duration<double>(Clock::now() - start_time).count();
+    if (!sink.writer.close()) {
+        std::cerr << "Failed writing " << options.output << std::endl;
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(1) <<
+        "Wrote " << sink.writer.record_count() << " positions from " << sink.games << " games in " << elapsed << " s" <<
+        " (" << sink.filtered << " tactical and " << sink.duplicates << " duplicate positions skipped)" << std::endl;
+    return 0;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
@@ -0,0 +1,193 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <rookmole/rookmole.h>
+using namespace rookmole;
+
+// Runs an EPD test suite: https://www.chessprogramming.org/Extended_Position_Description
+// A position counts as solved if the move found is one of its "bm" moves and none of its "am" moves.
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+struct Options {
+    std::string path;
+    int depth = 0;
+    std::chrono::milliseconds time{0};
+    int threads = 0;
+    bool split = false;  // All the threads on each position, instead of one position per thread.
+    std::string trace_path;
+};
+
+struct PositionResult {
+    bool solved = false;
+    uint64_t nodes = 0;
+};
+
+bool is_solved(const EpdRecord& record, MoveCoord move)
+{
+    const auto contains = [move](const MoveCoordVec& moves) {
+        return std::find(std::begin(moves), std::end(moves), move) != std::end(moves);
+    };
+    if (!record.best_moves.empty() && !contains(record.best_moves)) return false;
+    return !contains(record.avoid_moves);
+}
+
+std::string to_san_list(const GameState& s, const MoveCoordVec& moves)
+{
+    auto text = std::string{};
+    for (const auto m : moves) {
+        if (!text.empty()) text.push_back(' ');
+        text.append(to_san_move(s, m));
+    }
+    return text;
+}
+
+PositionResult analyse(const EpdRecord& record, const Options& options, int threads)
+{
+    auto limits = SearchLimits{};
+    limits.threads = threads;
+    if (options.depth > 0) limits.depth = options.depth;
+
+    auto signals = SearchSignals{};
+    if (options.time.count() > 0) signals.set_time_limits(options.time, options.time);
+
+    const auto root = GameNode{record.state};
+    const auto report = search(root, limits, signals);
+    const bool solved = is_valid(report.move.from) && is_solved(record, report.move);
+
+    auto line = std::ostringstream{};
+    line << std::left << std::setw(16) << (record.id.empty() ? "-" : record.id) << ' ' << (solved ? "solved" : "failed") <<
+        "  found " << std::setw(7) << (is_valid(report.move.from) ? to_san_move(record.state, report.move) : "-");
+    if (!record.best_moves.empty()) line << " bm " << to_san_list(record.state, record.best_moves);
+    if (!record.avoid_moves.empty()) line << " am " << to_san_list(record.state, record.avoid_moves);
+    line << "  depth " << report.depth << " nodes " << report.nodes;
+
+    static auto output_mutex = std::mutex{};
+    const auto lock = std::lock_guard{output_mutex};
+    std::cout << line.str() << std::endl;
+
+    return PositionResult{solved, report.nodes};
+}
+
+std::optional<Options> parse_options(int argc, char* argv[])
+{
+    auto options = Options{};
+    for (int i = 1; i < argc; ++i) {
+        const auto arg = std::string_view{argv[i]};
+        const bool has_value = i + 1 < argc;
+        if (arg == "--depth" && has_value) options.depth = std::atoi(argv[++i]);
+        else if (arg == "--time" && has_value) options.time = std::chrono::milliseconds{std::atoll(argv[++i])};
+        else if (arg == "--threads" && has_value) options.threads = std::atoi(argv[++i]);
+        else if (arg == "--split") options.split = true;
+        else if (arg == "--trace" && has_value) options.trace_path = argv[++i];
+        else if (!arg.empty() && arg[0] != '-' && options.path.empty()) options.path = arg;
+        else return std::nullopt;
+    }
+    if (options.path.empty()) return std::nullopt;
+    if (options.depth <= 0 && options.time.count() <= 0) options.depth = 4;
+    if (options.threads <= 0) options.threads = hardware_thread_count();
+    return options;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+int main(int argc, char* argv[])
+{
+    const auto options = parse_options(argc, argv);
+    if (!options) {
+        std::cerr << "Usage: rookmole.epd <suite.epd> [--depth N] [--time MS] [--threads N] [--split] [--trace PATH]\n"
+            "  --depth N    Search each position to the given depth (the default is 4).\n"
+            "  --time MS    Search each position for the given time.\n"
+            "  --threads N  The number of threads (the default is one per hardware thread).\n"
+            "  --split      Search the positions one by one with all the threads, instead of one per thread.\n"
+            "  --trace PATH Writes a Chrome trace of the threads (in builds with ROOKMOLE_TRACE).\n";
+        return 2;
+    }
+
+    const auto file = MappedFile{options->path};
+    if (!file.is_open()) {
+        std::cerr << "Cannot open " << options->path << std::endl;
+        return 1;
+    }
+
+    auto records = std::vector<EpdRecord>{};
+    auto text = file.view();
+    for (int line_number = 1; !text.empty(); ++line_number) {
+        const auto end = std::min(text.find('\n'), text.size());
+        auto line = text.substr(0, end);
+        text.remove_prefix(std::min(end + 1, text.size()));
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.remove_suffix(1);
+        if (line.empty() || line[0] == '#') continue;
+
+        if (auto record = parse_epd(line)) {
+            records.push_back(std::move(*record));
+        }
+        else {
+            std::cerr << "Skipping line " << line_number << ": " << line << std::endl;
+        }
+    }
+
+    if (!options->trace_path.empty()) {
+        if (!TracingEnabled) std::cerr << "Tracing is not compiled in, the trace will be empty" << std::endl;
+        start_tracing();
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const auto start_time = Clock::now();
+    auto results = std::vector<PositionResult>(records.size());
+
+    if (options->split) {
+        for (size_t i = 0; i < records.size(); ++i) {
+            results[i] = analyse(records[i], *options, options->threads);
+        }
+    }
+    else {
+        auto pool = ThreadPool{options->threads};
+        for (size_t i = 0; i < records.size(); ++i) {
+            pool.submit([&, i] { results[i] = analyse(records[i], *options, 1); });
+        }
+        pool.wait();
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start_time);
+    if (!options->trace_path.empty()) {
+        stop_tracing();
+        if (!write_chrome_trace(options->trace_path)) std::cerr << "Cannot write " << options->trace_path << std::endl;
+    }
+
+    uint64_t nodes = 0;
+    size_t solved = 0;
+    for (const auto& r : results) {
+        nodes += r.nodes;
+        solved += r.solved ? 1 : 0;
+    }
+
+    std::cout << "Solved " << solved << '/' << records.size() <<
+        ", nodes " << nodes <<
+        ", time " << std::fixed << std::setprecision(3) << (double)elapsed.count() / 1000000.0 << " s" <<
+        ", nps " << (elapsed.count() > 0 ? nodes * 1000000 / elapsed.count() : 0) <<
+        ", threads " << options->threads << (options->split ? " (all on each position)" : " (one position each)") << std::endl;
+    return 0;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
@@ -0,0 +1,304 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <rookmole/rookmole.h>
+using namespace rookmole;
+
+// Plays two engine configurations against each other. Every opening is played twice, with the colors swapped, and
+// the match stops early once a sequential probability ratio test (SPRT) accepts either hypothesis:
+// https://www.chessprogramming.org/Sequential_Probability_Ratio_Test
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+// Main lines of popular openings, a few moves deep.
+constexpr const char* BuiltinOpenings[] = {
+    "e2e4 e7e5 g1f3 b8c6 f1b5",         // Ruy Lopez
+    "e2e4 e7e5 g1f3 b8c6 f1c4",         // Italian Game
+    "e2e4 e7e5 g1f3 g8f6",              // Petrov Defence
+    "e2e4 e7e5 f2f4 e5f4",              // King's Gambit
+    "e2e4 c7c5 g1f3 d7d6",              // Sicilian Defence
+    "e2e4 c7c5 b1c3 b8c6",              // Closed Sicilian
+    "e2e4 e7e6 d2d4 d7d5",              // French Defence
+    "e2e4 c7c6 d2d4 d7d5",              // Caro-Kann Defence
+    "e2e4 d7d6 d2d4 g8f6",              // Pirc Defence
+    "e2e4 d7d5 e4d5 d8d5",              // Scandinavian Defence
+    "d2d4 d7d5 c2c4 e7e6",              // Queen's Gambit Declined
+    "d2d4 d7d5 c2c4 c7c6",              // Slav Defence
+    "d2d4 d7d5 c2c4 d5c4",              // Queen's Gambit Accepted
+    "d2d4 g8f6 c2c4 g7g6",              // King's Indian Defence
+    "d2d4 g8f6 c2c4 e7e6",              // Indian Defence
+    "d2d4 f7f5 g2g3 g8f6",              // Dutch Defence
+    "d2d4 d7d5 g1f3 g8f6 c1f4",         // London System
+    "c2c4 e7e5 b1c3 g8f6",              // English Opening
+    "c2c4 c7c5 g1f3 b8c6",              // Symmetrical English
+    "g1f3 d7d5 g2g3 g8f6",              // Réti Opening
+};
+
+struct EngineConfig {
+    std::string spec;
+    SearchLimits limits{4, 0, 1};
+    SearchOptions options;
+    std::chrono::milliseconds time{0};  // Per move; 0: unlimited.
+};
+
+// E.g. "depth=3,eval=basic,ordering=off". Keys: depth, nodes, time (ms per move), eval (full|basic), ordering (on|off).
+std::optional<EngineConfig> parse_engine_config(const std::string& spec)
+{
+    auto config = EngineConfig{};
+    config.spec = spec;
+
+    auto items = std::istringstream{spec};
+    auto item = std::string{};
+    while (std::getline(items, item, ',')) {
+        const auto eq = item.find('=');
+        if (eq == std::string::npos) return std::nullopt;
+        const auto key = item.substr(0, eq);
+        const auto value = item.substr(eq + 1);
+
+        if (key == "depth") config.limits.depth = std::atoi(value.c_str());
+        else if (key == "nodes") config.limits.nodes = std::strtoull(value.c_str(), nullptr, 10);
+        else if (key == "time") config.time = std::chrono::milliseconds{std::atoll(value.c_str())};
+        else if (key == "eval" && value == "full") config.options.evaluate = evaluate_cached;
+        else if (key == "eval" && value == "basic") config.options.evaluate = evaluate_basic;
+        else if (key == "ordering" && (value == "on" || value == "off")) config.options.move_ordering = value == "on";
+        else return std::nullopt;
+    }
+    if (config.limits.depth <= 0) return std::nullopt;
+    return config;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+struct MatchScore {
+    uint64_t wins = 0;    // Of the first engine.
+    uint64_t losses = 0;
+    uint64_t draws = 0;
+
+    uint64_t games() const noexcept { return wins + losses + draws; }
+    double score() const noexcept { return games() > 0 ? (wins + 0.5 * draws) / games() : 0.5; }
+
+    // The per-game variance of the score.
+    double variance() const noexcept {
+        if (games() == 0) return 0.0;
+        const double n = (double)games();
+        const double s = score();
+        return (wins / n) + (draws / n) / 4.0 - s * s;
+    }
+};
+
+double elo_to_score(double elo) noexcept { return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0)); }
+double score_to_elo(double score) noexcept {
+    score = std::clamp(score, 1e-6, 1.0 - 1e-6);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+struct Sprt {
+    double elo0 = 0.0;
+    double elo1 = 10.0;
+    double alpha = 0.05;
+    double beta = 0.05;
+
+    double lower_bound() const noexcept { return std::log(beta / (1.0 - alpha)); }
+    double upper_bound() const noexcept { return std::log((1.0 - beta) / alpha); }
+
+    // The generalized SPRT log-likelihood ratio, in the normal approximation of the score distribution.
+    double llr(const MatchScore& score) const noexcept {
+        const double variance = score.variance();
+        if (score.games() == 0 || variance <= 0.0) return 0.0;
+        const double s0 = elo_to_score(elo0);
+        const double s1 = elo_to_score(elo1);
+        return (double)score.games() * (s1 - s0) * (2.0 * score.score() - s0 - s1) / (2.0 * variance);
+    }
+};
+
+std::string format_score(const MatchScore& score, const Sprt& sprt)
+{
+    const double n = (double)score.games();
+    const double margin = n > 0 ? 1.96 * std::sqrt(score.variance() / n) : 0.0;
+    const double elo = score_to_elo(score.score());
+    const double elo_margin = (score_to_elo(score.score() + margin) - score_to_elo(score.score() - margin)) / 2.0;
+
+    auto out = std::ostringstream{};
+    out << std::fixed << std::setprecision(1) <<
+        "Games " << score.games() << ": +" << score.wins << " -" << score.losses << " =" << score.draws <<
+        ", score " << (100.0 * score.score()) << "%, Elo " << elo << " +/- " << elo_margin <<
+        std::setprecision(2) << ", LLR " << sprt.llr(score) << " [" << sprt.lower_bound() << ", " << sprt.upper_bound() << "]";
+    return out.str();
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+GameResult play_game(GameNode node, const EngineConfig& white, const EngineConfig& black)
+{
+    while (!is_terminal(node)) {
+        const auto& engine = is_white(node.state.player_to_move) ? white : black;
+        auto signals = SearchSignals{};
+        if (engine.time.count() > 0) signals.set_time_limits(engine.time, engine.time);
+        const auto report = search(node, engine.limits, signals, engine.options);
+        node = make_move(node.state, report.move);
+    }
+
+    // Stalemate or the move limit.
+    if (node.has_any_legal_move() || !node.king_in_check()) return GameResult::Draw;
+    return is_white(node.state.player_to_move) ? GameResult::BlackWon : GameResult::WhiteWon;
+}
+
+// The opening for a pair of games: a book line followed by a few random moves, so that games do not repeat.
+GameNode make_opening(const std::vector<GameState>& openings, size_t pair_index, int random_plies)
+{
+    auto rng = std::mt19937_64{pair_index};
+    auto node = GameNode{openings[pair_index % openings.size()]};
+    for (int i = 0; i < random_plies && !is_terminal(node); ++i) {
+        const auto& next_moves = node.next_moves();
+        node = make_move(node.state, next_moves[rng() % next_moves.size()]);
+    }
+    return is_terminal(node) ? GameNode{openings[pair_index % openings.size()]} : node;
+}
+
+std::vector<GameState> load_openings(const std::string& path)
+{
+    auto openings = std::vector<GameState>{};
+    if (path.empty()) {
+        for (const auto line : BuiltinOpenings) {
+            auto s = make_start_state();
+            auto moves = std::istringstream{line};
+            auto move = std::string{};
+            while (moves >> move) s = make_move(s, *parse_uci_move(s, move)).state;
+            openings.push_back(s);
+        }
+        return openings;
+    }
+
+    auto file = std::ifstream{path};
+    auto line = std::string{};
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        if (auto s = parse_fen(line)) openings.push_back(*s);
+        else if (auto record = parse_epd(line)) openings.push_back(record->state);
+    }
+    return openings;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+int main(int argc, char* argv[])
+{
+    auto engines = std::vector<EngineConfig>{};
+    auto sprt = Sprt{};
+    uint64_t max_games = 1000;
+    int threads = 0;
+    int random_plies = 4;
+    auto openings_path = std::string{};
+    bool usage = false;
+
+    for (int i = 1; i < argc && !usage; ++i) {
+        const auto arg = std::string_view{argv[i]};
+        const bool has_value = i + 1 < argc;
+        if (arg == "--engine" && has_value) {
+            if (auto config = parse_engine_config(argv[++i])) engines.push_back(*config);
+            else usage = true;
+        }
+        else if (arg == "--games" && has_value) max_games = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--threads" && has_value) threads = std::atoi(argv[++i]);
+        else if (arg == "--openings" && has_value) openings_path = argv[++i];
+        else if (arg == "--random-plies" && has_value) random_plies = std::atoi(argv[++i]);
+        else if (arg == "--elo0" && has_value) sprt.elo0 = std::atof(argv[++i]);
+        else if (arg == "--elo1" && has_value) sprt.elo1 = std::atof(argv[++i]);
+        else if (arg == "--alpha" && has_value) sprt.alpha = std::atof(argv[++i]);
+        else if (arg == "--beta" && has_value) sprt.beta = std::atof(argv[++i]);
+        else usage = true;
+    }
+
+    if (usage || engines.size() != 2) {
+        std::cerr << "Usage: rookmole.match --engine SPEC --engine SPEC [options]\n"
+            "  SPEC is a comma-separated list of: depth=N, nodes=N, time=MS (per move), eval=full|basic, ordering=on|off\n"
+            "  --games N         The maximum number of games (the default is 1000).\n"
+            "  --threads N       Concurrent games (the default is one per hardware thread).\n"
+            "  --openings FILE   FEN or EPD start positions (the default is a built-in set).\n"
+            "  --random-plies N  Random moves played after each opening (the default is 4).\n"
+            "  --elo0 E --elo1 E SPRT hypotheses on the Elo of the first engine (the defaults are 0 and 10).\n"
+            "  --alpha P --beta P SPRT error probabilities (the defaults are 0.05).\n";
+        return 2;
+    }
+
+    const auto openings = load_openings(openings_path);
+    if (openings.empty()) {
+        std::cerr << "No openings in " << openings_path << std::endl;
+        return 1;
+    }
+
+    std::cout << "Engine 1: " << engines[0].spec << "\nEngine 2: " << engines[1].spec << std::endl;
+
+    auto score = MatchScore{};
+    auto score_mutex = std::mutex{};
+    auto stop = std::atomic<bool>{false};
+
+    const auto play = [&](uint64_t game_index) {
+        if (stop) return;
+
+        // Games are played in pairs from the same opening, with the colors swapped.
+        const auto opening = make_opening(openings, game_index / 2, random_plies);
+        const bool first_is_white = game_index % 2 == 0;
+        const auto result = first_is_white ?
+            play_game(opening, engines[0], engines[1]) :
+            play_game(opening, engines[1], engines[0]);
+
+        const auto lock = std::lock_guard{score_mutex};
+        if (result == GameResult::Draw) ++score.draws;
+        else if ((result == GameResult::WhiteWon) == first_is_white) ++score.wins;
+        else ++score.losses;
+
+        const double llr = sprt.llr(score);
+        const bool decided = llr <= sprt.lower_bound() || llr >= sprt.upper_bound();
+        if (score.games() % 20 == 0 && !stop) {
+            std::cout << format_score(score, sprt) << std::endl;
+        }
+        if (decided) stop = true;
+    };
+
+    using Clock = std::chrono::steady_clock;
+    const auto start_time = Clock::now();
+    {
+        auto pool = ThreadPool{threads};
+        for (uint64_t i = 0; i < max_games; ++i) {
+            pool.submit([&play, i] { play(i); });
+        }
+        pool.wait();
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start_time);
+
+    const double llr = sprt.llr(score);
+    std::cout << format_score(score, sprt) << "\nSPRT: ";
+    if (llr >= sprt.upper_bound()) std::cout << "H1 accepted (Elo >= " << sprt.elo1 << ")";
+    else if (llr <= sprt.lower_bound()) std::cout << "H0 accepted (Elo <= " << sprt.elo0 << ")";
+    else std::cout << "inconclusive";
+    std::cout << "\nTime: " << (double)elapsed.count() / 1000.0 << " s" << std::endl;
+    return 0;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
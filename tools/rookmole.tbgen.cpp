@@ -0,0 +1,121 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <rookmole/rookmole.h>
+using namespace rookmole;
+
+// Generates the endgame tablebases into a directory, or looks a position up in them.
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+int generate(int argc, char* argv[])
+{
+    auto directory = std::string{};
+    auto signatures = std::vector<std::string>{};
+    int threads = 0;
+
+    for (int i = 2; i < argc; ++i) {
+        const auto arg = std::string_view{argv[i]};
+        if (arg == "--threads" && i + 1 < argc) threads = std::atoi(argv[++i]);
+        else if (directory.empty()) directory = arg;
+        else signatures.emplace_back(arg);
+    }
+    if (directory.empty()) return 2;
+    if (signatures.empty()) signatures.assign(std::begin(TablebaseSignatures), std::end(TablebaseSignatures));
+
+    // The tables generated before are reused, also as the targets of captures and promotions.
+    auto tablebases = Tablebases{};
+    tablebases.load_all(directory);
+
+    for (const auto& signature : signatures) {
+        if (tablebases.has(signature)) {
+            std::cout << signature << ": present" << std::endl;
+            continue;
+        }
+
+        const auto start_time = std::chrono::steady_clock::now();
+        if (!tablebases.generate(signature, threads)) {
+            std::cerr << signature << ": cannot generate (unsupported, or a table it depends on is missing)" << std::endl;
+            return 1;
+        }
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        if (!tablebases.write(directory, signature)) {
+            std::cerr << "Cannot write " << tablebase_file_name(signature) << " to " << directory << std::endl;
+            return 1;
+        }
+
+        const auto stats = *tablebases.stats(signature);
+        std::cout << signature << ": " << stats.positions << " positions, " << stats.wins << " won, " <<
+            stats.draws << " drawn, " << stats.losses << " lost, longest mate " << stats.longest_mate <<
+            " plies (" << elapsed << " s)" << std::endl;
+    }
+    return 0;
+}
+
+int probe(int argc, char* argv[])
+{
+    if (argc < 4) return 2;
+    auto tablebases = Tablebases{};
+    if (tablebases.load_all(argv[2]) == 0) {
+        std::cerr << "No tables in " << argv[2] << std::endl;
+        return 1;
+    }
+
+    auto fen = std::string{};
+    for (int i = 3; i < argc; ++i) {
+        if (!fen.empty()) fen.push_back(' ');
+        fen.append(argv[i]);
+    }
+    const auto state = parse_fen(fen);
+    if (!state) {
+        std::cerr << "Invalid FEN: " << fen << std::endl;
+        return 1;
+    }
+
+    const auto result = tablebases.probe(*state);
+    if (!result) {
+        std::cout << "Not covered" << std::endl;
+    }
+    else if (result->wdl == TablebaseWdl::Draw) {
+        std::cout << "Draw" << std::endl;
+    }
+    else {
+        std::cout << (result->wdl == TablebaseWdl::Win ? "Win" : "Loss") << ", mate in " << result->plies << " plies" << std::endl;
+    }
+    return 0;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+int main(int argc, char* argv[])
+{
+    const auto command = argc > 1 ? std::string_view{argv[1]} : std::string_view{};
+    int exit_code = 2;
+    if (command == "generate") exit_code = generate(argc, argv);
+    else if (command == "probe") exit_code = probe(argc, argv);
+
+    if (exit_code == 2) {
+        std::cerr << "Usage: rookmole.tbgen generate <directory> [signature...] [--threads N]\n"
+            "         Builds the missing tables (by default: KQK KRK KPK KBNK KQKR KRKP), in the given order.\n"
+            "       rookmole.tbgen probe <directory> <fen>\n";
+    }
+    return exit_code;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
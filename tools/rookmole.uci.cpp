@@ -0,0 +1,334 @@
+/*
+  MIT License
+  Copyright (c) Mariusz Łapiński <gmail:isameru>
+
+   ██████╗  ██████╗  ██████╗ ██╗  ██╗███╗   ███╗ ██████╗ ██╗     ███████╗
+   ██╔══██╗██╔═══██╗██╔═══██╗██║ ██╔╝████╗ ████║██╔═══██╗██║     ██╔════╝
+   ██████╔╝██║   ██║██║   ██║█████╔╝ ██╔████╔██║██║   ██║██║     █████╗
+   ██╔══██╗██║   ██║██║   ██║██╔═██╗ ██║╚██╔╝██║██║   ██║██║     ██╔══╝
+   ██║  ██║╚██████╔╝╚██████╔╝██║  ██╗██║ ╚═╝ ██║╚██████╔╝███████╗███████╗
+   ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ ╚═╝  ╚═╝╚═╝     ╚═╝ ╚═════╝ ╚══════╝╚══════╝
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <rookmole/rookmole.h>
+using namespace rookmole;
+
+// Universal Chess Interface: https://www.shredderchess.com/chess-features/uci-universal-chess-interface.html
+// Besides, the "bench [depth]" command, also given on the command line, prints the node count signature of the search
+// and its speed (see `run_search_benchmark`).
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+using Milliseconds = std::chrono::milliseconds;
+
+constexpr uint64_t MaxHashMegabytes = 65536;
+
+struct TimeBudget {
+    Milliseconds soft;  // Do not start another iteration after that.
+    Milliseconds hard;  // Abort the search.
+};
+
+TimeBudget allot_time(Milliseconds time_left, Milliseconds increment, int moves_to_go)
+{
+    const auto moves = moves_to_go > 0 ? moves_to_go : 30;
+    const auto safety_margin = std::min(time_left / 10, Milliseconds{50});
+    const auto usable = std::max(time_left - safety_margin, Milliseconds{1});
+    const auto hard = std::min(usable, 4 * (time_left / moves + increment));
+    const auto soft = std::min(hard, time_left / moves + 3 * increment / 4);
+    return {std::max(soft, Milliseconds{1}), std::max(hard, Milliseconds{1})};
+}
+
+void print_benchmark(std::ostream& out, int depth)
+{
+    const auto report = run_search_benchmark(depth, [&out](size_t index, const SearchReport& r) {
+        out << "Position " << (index + 1) << '/' << BenchmarkPositionCount << ": " << r.nodes << " nodes" << std::endl;
+    });
+    out << "\nDepth           : " << depth <<
+        "\nTotal time (ms) : " << std::chrono::duration_cast<Milliseconds>(report.time).count() <<
+        "\nNodes searched  : " << report.nodes <<
+        "\nNodes/second    : " << report.nps() << std::endl;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+class UciEngine {
+    GameNode _root = make_start_node();
+
+    // The search runs on a worker thread, so that the commands are handled while it is running.
+    std::thread _search_thread;
+    SearchSignals _signals;
+    std::atomic<bool> _hold_best_move{false};  // While pondering or in infinite mode, wait for "stop" or "ponderhit".
+    TimeBudget _ponder_budget{};
+    bool _ponder_budget_set = false;
+
+    OpeningBook _book;
+    Tablebases _tablebases;
+
+    std::mutex _output_mutex;
+
+public:
+    ~UciEngine() { stop_search(); }
+
+    void run(std::istream& in) {
+        std::string line;
+        while (std::getline(in, line)) {
+            auto tokens = std::istringstream{line};
+            std::string command;
+            tokens >> command;
+
+            if (command == "uci") {
+                send("id name rookmole");
+                send("id author Mariusz Lapinski");
+                send("option name Hash type spin default 1 min 0 max " + std::to_string(MaxHashMegabytes));
+                send("option name Book type string default <empty>");
+                send("option name TablebasePath type string default <empty>");
+                send("uciok");
+            }
+            else if (command == "isready") {
+                send("readyok");
+            }
+            else if (command == "setoption") {
+                stop_search();
+                on_setoption(tokens);
+            }
+            else if (command == "ucinewgame") {
+                stop_search();
+                configure_eval_cache(eval_cache_size_log2());  // Clears the cache.
+            }
+            else if (command == "position") {
+                stop_search();
+                on_position(tokens);
+            }
+            else if (command == "go") {
+                stop_search();
+                on_go(tokens);
+            }
+            else if (command == "stop") {
+                stop_search();
+            }
+            else if (command == "ponderhit") {
+                on_ponderhit();
+            }
+            else if (command == "bench") {
+                stop_search();
+                int depth = DefaultBenchmarkDepth;
+                tokens >> depth;
+                auto lock = std::lock_guard<std::mutex>{_output_mutex};
+                print_benchmark(std::cout, std::clamp(depth, 1, MaxSearchDepth));
+            }
+            else if (command == "quit") {
+                break;
+            }
+        }
+    }
+
+private:
+    void send(const std::string& line) {
+        auto lock = std::lock_guard<std::mutex>{_output_mutex};
+        std::cout << line << std::endl;
+    }
+
+    void stop_search() {
+        if (_search_thread.joinable()) {
+            _signals.stop = true;
+            _hold_best_move = false;
+            _search_thread.join();
+        }
+    }
+
+    void on_setoption(std::istringstream& tokens) {
+        // "setoption name <id> [value <x>]": the name may have several words, and the value, a path for example,
+        // runs to the end of the line.
+        std::string token, name, value;
+        while (tokens >> token && token != "value") {
+            if (token != "name") name += (name.empty() ? "" : " ") + token;
+        }
+        std::getline(tokens >> std::ws, value);
+        value.erase(value.find_last_not_of(" \t\r") + 1);
+
+        if (name == "Hash") {
+            // The size of the evaluation cache in megabytes, rounded down to a power of two entries.
+            uint64_t megabytes = 0;
+            const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), megabytes);
+            if (error == std::errc::result_out_of_range) megabytes = MaxHashMegabytes;
+            else if (error != std::errc{} || end != value.data() + value.size()) {
+                send("info string invalid Hash value " + value);
+                return;
+            }
+            megabytes = std::min<uint64_t>(megabytes, MaxHashMegabytes);
+            int size_log2 = 0;
+            while (megabytes != 0 && (uint64_t{16} << (size_log2 + 1)) <= (megabytes << 20)) ++size_log2;
+            try {
+                configure_eval_cache(size_log2);
+            }
+            catch (const std::bad_alloc&) {
+                send("info string cannot allocate a Hash of " + std::to_string(megabytes) + " MB, keeping the previous one");
+            }
+        }
+        else if (name == "Book") {
+            _book = value.empty() || value == "<empty>" ? OpeningBook{} : OpeningBook{value};
+            if (!value.empty() && value != "<empty>" && !_book.is_open()) send("info string cannot open book " + value);
+        }
+        else if (name == "TablebasePath") {
+            // A directory of the tables generated by rookmole.tbgen.
+            _tablebases = Tablebases{};
+            if (!value.empty() && value != "<empty>") {
+                send("info string " + std::to_string(_tablebases.load_all(value)) + " tablebases found");
+            }
+        }
+    }
+
+    void on_position(std::istringstream& tokens) {
+        std::string token;
+        tokens >> token;
+
+        auto state = make_start_state();
+        if (token == "fen") {
+            auto fen = std::string{};
+            while (tokens >> token && token != "moves") {
+                if (!fen.empty()) fen.push_back(' ');
+                fen.append(token);
+            }
+            const auto fen_state = parse_fen(fen);
+            if (!fen_state) {
+                send("info string invalid fen " + fen);
+                return;
+            }
+            state = *fen_state;
+        }
+        else if (token == "startpos") {
+            tokens >> token;
+        }
+        else {
+            return;
+        }
+
+        if (token == "moves") {
+            while (tokens >> token) {
+                const auto move = parse_uci_move(state, token);
+                if (!move) {
+                    send("info string illegal move " + token);
+                    break;
+                }
+                state = make_move(state, *move).state;
+            }
+        }
+
+        // The move limit of `is_terminal` is a self-play rule; in a tournament the GUI adjudicates the game.
+        state.move_count = 0;
+        _root = GameNode{state};
+    }
+
+    void on_go(std::istringstream& tokens) {
+        auto limits = SearchLimits{};
+        Milliseconds time_left[2] = {Milliseconds{0}, Milliseconds{0}};
+        Milliseconds increment[2] = {Milliseconds{0}, Milliseconds{0}};
+        Milliseconds move_time{0};
+        int moves_to_go = 0;
+        bool infinite = false;
+        bool ponder = false;
+
+        std::string token;
+        while (tokens >> token) {
+            long long value = 0;
+            if (token == "infinite") infinite = true;
+            else if (token == "ponder") ponder = true;
+            else if (token == "wtime" && tokens >> value) time_left[Player::White] = Milliseconds{value};
+            else if (token == "btime" && tokens >> value) time_left[Player::Black] = Milliseconds{value};
+            else if (token == "winc" && tokens >> value) increment[Player::White] = Milliseconds{value};
+            else if (token == "binc" && tokens >> value) increment[Player::Black] = Milliseconds{value};
+            else if (token == "movestogo" && tokens >> value) moves_to_go = static_cast<int>(value);
+            else if (token == "movetime" && tokens >> value) move_time = Milliseconds{value};
+            else if (token == "depth" && tokens >> value) limits.depth = static_cast<int>(value);
+            else if (token == "nodes" && tokens >> value) limits.nodes = static_cast<uint64_t>(value);
+        }
+
+        const auto me = _root.state.player_to_move;
+        _ponder_budget_set = move_time.count() > 0 || time_left[me].count() > 0;
+        _ponder_budget = move_time.count() > 0 ?
+            TimeBudget{move_time, move_time} :
+            allot_time(time_left[me], increment[me], moves_to_go);
+
+        _signals.reset();
+        if (!infinite && !ponder && _ponder_budget_set) {
+            _signals.set_time_limits(_ponder_budget.soft, _ponder_budget.hard);
+        }
+        _hold_best_move = infinite || ponder;
+
+        _search_thread = std::thread{[this, limits, root = _root] {
+            auto options = SearchOptions{};
+            if (_book.is_open()) options.book = &_book;
+            if (_tablebases.size() != 0) options.tablebases = &_tablebases;
+            const auto report = search(root, limits, _signals, options, [this, &root](const SearchReport& r) {
+                send(format_info(root, r));
+            });
+
+            while (_hold_best_move && !_signals.stop) {
+                std::this_thread::sleep_for(Milliseconds{1});
+            }
+
+            auto best_move = report.move;
+            if (is_invalid(best_move.from) && root.has_any_legal_move()) {
+                best_move = root.next_moves().front();
+            }
+
+            auto line = std::string{"bestmove "};
+            line.append(is_valid(best_move.from) ? to_uci_move(root.state, best_move) : "0000");
+            if (report.pv.size() >= 2 && report.pv[0] == best_move) {
+                line.append(" ponder ");
+                line.append(to_uci_move(make_move(root.state, best_move).state, report.pv[1]));
+            }
+            send(line);
+        }};
+    }
+
+    void on_ponderhit() {
+        // The opponent played the expected move: the search continues as a regular timed one.
+        if (_ponder_budget_set) {
+            _signals.set_time_limits(_ponder_budget.soft, _ponder_budget.hard);
+        }
+        _hold_best_move = false;
+    }
+
+    static std::string format_info(const GameNode& root, const SearchReport& r) {
+        auto out = std::ostringstream{};
+        out << "info depth " << r.depth;
+        if (const auto mate = mate_in_moves(r.value)) out << " score mate " << mate;
+        else out << " score cp " << r.value;
+        out << " nodes " << r.nodes << " nps " << r.nps() <<
+            " time " << std::chrono::duration_cast<Milliseconds>(r.time).count() <<
+            " pv " << to_uci_line(root.state, r.pv);
+        return out.str();
+    }
+};
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-
+
+int main(int argc, char* argv[])
+{
+    std::ios::sync_with_stdio(false);
+    if (argc >= 2 && std::string_view{argv[1]} == "bench") {
+        const int depth = argc >= 3 ? std::atoi(argv[2]) : DefaultBenchmarkDepth;
+        print_benchmark(std::cout, std::clamp(depth, 1, MaxSearchDepth));
+        return 0;
+    }
+
+    auto engine = UciEngine{};
+    engine.run(std::cin);
+    return 0;
+}
+
+//=≡=-=♔=-=≡=-=♕=-=≡=-=♖=-=≡=-=♗=-=≡=-=♘=-=≡=-=♙=-=≡=-=♚=-=≡=-=♛=-=≡=-=♜=-=≡=-=♝=-=≡=-=♞=-=≡=-=♟︎=-